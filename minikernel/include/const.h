@@ -21,9 +21,15 @@
 #define NULL (void *) 0		/* por si acaso no esta ya definida */
 #endif
 
+#ifndef MAX_PROC		/* el simulador usa una tabla mayor */
 #define MAX_PROC 10		/* dimension de tabla de procesos */
+#endif
 
 #define TAM_PILA 32768
+#define TAM_PILA_MIN 8192	/* limites para crear_proceso_ext */
+#define TAM_PILA_MAX 1048576
+#define MAX_ARGS 16		/* argumentos de crear_proceso_args */
+#define TAM_MAX_ARGS 1024	/* bytes que ocupan en la pila del proceso */
 
 
 /*
@@ -35,6 +41,7 @@
 #define EJECUCION 2
 #define BLOQUEADO 3
 #define ESPERANDO 4
+#define ZOMBI 5		/* Terminado pero con recursos sin liberar */
 
 /*
  * Niveles de ejecucin del procesador. 
@@ -61,8 +68,15 @@
 #define LLAM_SIS 4      /* vector usado para llamadas */
 #define INT_SW 5	/* vector usado para interrupciones software */
 
+/*
+ * Valores iniciales de los parametros del kernel; en marcha se usan los
+ * de tabla_parametros (ver leer_parametro/fijar_parametro)
+ */
+
 /* frecuencia de reloj requerida (ticks/segundo) */
 #define TICK 100
+#define TICK_MIN 10
+#define TICK_MAX 1000
 
 //Ticks por rodaja
 #define TICKS_POR_RODAJA 10
@@ -71,6 +85,81 @@
 #define VUELTAS_INIT 0
 #define VUELTAS_MAX 3
 
+//Ticks que duerme el proceso castigado al agotar VUELTAS_MAX rodajas
+#define TICKS_CASTIGO ((TICKS_POR_RODAJA * 3) / 4)
+
+//Ticks que puede esperar un proceso en la cola de listos antes de que se
+//le adelante por envejecimiento
+#define UMBRAL_ENVEJECIMIENTO 50
+
+//Periodo en que se reparte el procesador entre grupos (fijar_reparto)
+#define PERIODO_REPARTO 100
+
+//Holgura del despertar de los dormidos: ticks que se puede retrasar para
+//despertarlo junto a otros (fijar_holgura)
+#define HOLGURA_DEFECTO 0
+#define HOLGURA_MAX 1000
+
+//Carga media: se muestrea cada decima de segundo. Factores de
+//decaimiento e^(-0.1/T) en coma fija para T = 1, 5 y 15 s. Solo valen
+//si el tick es multiplo de MUESTRAS_CARGA_POR_SEG (fijar_parametro)
+#define MUESTRAS_CARGA_POR_SEG 10
+#define EXP_CARGA_1 59299
+#define EXP_CARGA_5 64238
+#define EXP_CARGA_15 65101
+
+//Tiempo real: utilizacion maxima admitida para el conjunto de tareas
+//EDF, en tanto por mil (se deja margen para los procesos normales)
+#define UTIL_MAX_TIEMPO_REAL 900
+
+//Alarmas: pila propia en la que se ejecuta el manejador de usuario
+#define TAM_PILA_ALARMA 16384
+
+//Espera de eventos
+#define MAX_ESPERAS 2		/* fuentes en que puede esperar un proceso */
+#define TAM_BUF_TECLADO 32	/* caracteres recibidos aun no leidos */
+
+//Trabajo en espera: reserva de pilas de TAM_PILA que se ponen a cero
+//por trozos
+#define TAM_RESERVA_PILAS 4
+#define TAM_TROZO_CERO 4096
+
+//Zombis liberados como maximo en cada pasada por espera_int
+#define ZOMBIS_POR_PASADA 4
+
+//Semaforos y barreras con nombre
+#define NUM_SEMAFOROS 16	/* en todo el sistema */
+#define MAX_NOMBRE_SEM 16	/* incluido el nulo final */
+
+//Traza de llamadas al sistema
+#define TAM_ANILLO_LLAMADAS 32	/* llamadas sin leer por proceso trazado */
+
+//Tuberias
+#define MAX_DESC 8		/* descriptores abiertos por proceso */
+#define TAM_TUBERIA 64		/* capacidad del buffer de cada tuberia */
+#define LECTURA 0		/* extremo de lectura */
+#define ESCRITURA 1		/* extremo de escritura */
+
+//Asignador de objetos del kernel
+#define TAM_ARENA 65536		/* memoria para todos los objetos dinamicos */
+#define TAM_SLAB 4096		/* bloque que se reparte entre objetos de un tipo */
+#define MAX_CACHES 8		/* tipos de objeto distintos */
+
+//Registro y reproduccion de interrupciones (ver minikernel/traza.sh)
+#define TRAZA_NINGUNA 0
+#define TRAZA_GRABAR 1
+#define TRAZA_REPRODUCIR 2
+#ifndef MODO_TRAZA
+#define MODO_TRAZA TRAZA_NINGUNA
+#endif
+
+/* Tipos de evento de la traza */
+#define EV_FIN 0	/* marca el final de la traza */
+#define EV_RELOJ 1
+#define EV_TERMINAL 2
+#define EV_SW 3
+#define EV_LLAMADA 4
+
 /* direccin de puerto de E/S del terminal */
 #define DIR_TERMINAL 1
 
@@ -22,6 +22,11 @@
 #include "HAL.h"
 #include "llamsis.h"
 
+/* los vectores que ve el usuario deben coincidir con los del kernel */
+#if NUM_VECTORES != NVECTORES || VECTOR_LLAMSIS != LLAM_SIS
+#error "llamsis.h: NUM_VECTORES o VECTOR_LLAMSIS no coinciden con const.h"
+#endif
+
 /*
  *
  * Definicion del tipo que corresponde con el BCP.
@@ -30,18 +35,91 @@
  */
 typedef struct BCP_t *BCPptr;
 
+/*
+ * Tuberias - Descriptor de un extremo de tuberia abierto por un proceso
+ */
+typedef struct {
+	struct tuberia_t *tuberia;	/* NULL si el descriptor esta libre */
+	int extremo;			/* LECTURA|ESCRITURA */
+} descriptor;
+
+/*
+ * Espera de eventos - Fuente de eventos: lista doble de los nodos de
+ * espera de los procesos que la esperan
+ */
+typedef struct fuente_eventos_t {
+	struct nodo_espera_t *primero;
+	int evento;			/* EVENTO_TECLADO|EVENTO_HIJO */
+} fuente_eventos;
+
+/*
+ * Traza de llamadas - Anillo con las ultimas llamadas anotadas de un
+ * proceso trazado; si se llena, la nueva pisa a la mas antigua
+ */
+typedef struct {
+	unsigned long mascara;		/* servicios que se anotan */
+	unsigned long anotadas;		/* llamadas anotadas desde trazar */
+	int primera;			/* registro mas antiguo sin leer */
+	int num;			/* registros sin leer */
+	info_llamada registros[TAM_ANILLO_LLAMADAS];
+} anillo_llamadas;
+
 typedef struct BCP_t {
         int id;				/* ident. del proceso */
         int estado;			/* TERMINADO|LISTO|EJECUCION|BLOQUEADO*/
         contexto_t contexto_regs;	/* copia de regs. de UCP */
         void *pila;			/* dir. inicial de la pila */
+	int tam_pila;			/* tam. de la pila en bytes */
+	long memoria;			/* bytes de pila reservados por el proceso */
+	int argc;			/* argumentos copiados en lo alto de la pila */
+	char **argv;
 	BCPptr siguiente;		/* puntero a otro BCP */
 	void *info_mem;			/* descriptor del mapa de memoria */
 	int ticks;	//Ticks que falten de dormir 
+	int holgura;	//Ticks que se puede retrasar su despertar
 	int rodaja;	//Rodajas que le quedan
 	int vueltas; 	//Vueltas que lleva el proceso
 	int ppid;	//Identificador del proceso padre
+	int gid;	//Grupo al que pertenece
+	BCPptr sig_grupo;	//Miembros del grupo (lista doble)
+	BCPptr ant_grupo;
+	struct lista_BCPs_t *lista_bloqueo;	//Lista en que esta bloqueado
 	int num_hijos;	//Nmero de hijos del proceso
+	descriptor descriptores[MAX_DESC];	//Descriptores de tuberia abiertos
+	char semaforos[NUM_SEMAFOROS];	//1 si tiene abierto ese semaforo
+	int num_llamadas;	//Llamadas al sistema realizadas
+	int activaciones;	//Veces que ha pasado a ejecucion
+	int tiempo_real;	//1 si es una tarea periodica EDF
+	int periodo;		//Periodo en ticks (plazo = fin del periodo)
+	int presupuesto;	//Ticks de procesador por periodo
+	int consumido;		//Ticks consumidos en el periodo actual
+	unsigned long plazo;	//Tick en que vence el trabajo actual
+	unsigned long activacion;	//Tick de comienzo del siguiente periodo
+	int plazos_perdidos;	//Trabajos que no acabaron en su plazo
+	int sin_presupuesto;	//Agoto el presupuesto sin acabar el trabajo
+	int alarma_ticks;	//Ticks que faltan para la alarma (0: no hay)
+	int alarma_periodo;	//Ticks entre alarmas periodicas (0: una sola)
+	void (*manejador)();	//Funcion de usuario que atiende la alarma
+	int alarma_pendiente;	//Alarma vencida aun no entregada
+	int en_alarma;		//1 mientras ejecuta el manejador
+	void *pila_alarma;	//Pila del manejador (se crea en la primera alarma)
+	contexto_t contexto_alarma;	//Contexto del manejador
+	int esperando_eventos;	//1 si esta bloqueado en esperar_eventos
+	int eventos_listos;	//Eventos ocurridos durante la espera
+	int eventos_ticks;	//Ticks que faltan para el plazo (0: sin plazo)
+	struct nodo_espera_t *esperas[MAX_ESPERAS];	//Nodos en las fuentes
+	int num_esperas;
+	int hijos_terminados;	//Hijos terminados aun no notificados
+	fuente_eventos fuente_hijos;	//Donde espera la terminacion de hijos
+	unsigned long listo_desde;	//Tick en que entro en la cola de listos
+	unsigned long veces_listo;	//Esperas en listos completadas
+	unsigned long espera_total;	//Ticks esperados en listos en total
+	unsigned long espera_max;	//Espera en listos mas larga
+	int envejecido;		//1 si se le ha adelantado y aun no ha ejecutado
+	unsigned long envejecimientos;	//Veces que se le ha adelantado
+	info_perfil *perfil;	//Muestras del PC (NULL: no se perfila)
+	anillo_llamadas *llamadas;	//Llamadas anotadas (NULL: no se traza)
+	int perfilar_hijos;	//1 si sus nuevos hijos se perfilan
 } BCP;
 
 /*
@@ -52,12 +130,91 @@ typedef struct BCP_t {
  *
  */
 
-typedef struct{
+typedef struct lista_BCPs_t {
 	BCP *primero;
 	BCP *ultimo;
 } lista_BCPs;
 
 
+/*
+ * Grupos - Procesos de un grupo, enlazados por sig_grupo/ant_grupo en
+ * sus BCPs, y procesos que esperan a que se vacie. Como cada grupo
+ * tiene al menos un miembro, basta una entrada por proceso. Tambien
+ * lleva la cuenta del reparto del procesador entre grupos.
+ */
+typedef struct {
+	BCP *primero;
+	int miembros;		/* 0: entrada libre */
+	lista_BCPs esperando;
+	int peso;
+	int cuota;		/* ticks por periodo (0: sin limite) */
+	unsigned long uso;	/* ticks en el periodo en curso */
+	unsigned long total;
+	int estrangulado;	/* 1 si ha agotado la cuota del periodo */
+	unsigned long estrangulamientos;
+	unsigned long generacion;	/* veces que se ha vaciado la entrada */
+} grupo;
+
+grupo tabla_grupos[MAX_PROC];
+
+/*
+ * Semaforos - Semaforos contadores y barreras de n partes, con nombre.
+ * La barrera deja pasar a todos juntos cuando llega el n-esimo. La
+ * entrada se libera cuando la cierran todos los que la abrieron.
+ */
+typedef struct {
+	char nombre[MAX_NOMBRE_SEM];	/* "" si la entrada esta libre */
+	int valor;			/* semaforo: valor actual */
+	int partes;			/* barrera: procesos por fase (0: semaforo) */
+	int llegados;			/* barrera: llegados en la fase actual */
+	int abiertos;			/* procesos que lo tienen abierto */
+	lista_BCPs bloqueados;
+} semaforo;
+
+semaforo tabla_semaforos[NUM_SEMAFOROS];
+
+/*
+ * Tuberias - Buffer circular en el kernel con sus listas de espera.
+ * Se considera libre cuando no le quedan lectores ni escritores.
+ */
+typedef struct tuberia_t {
+	char buffer[TAM_TUBERIA];
+	int ini;			/* posicion del proximo byte a leer */
+	int num;			/* bytes almacenados */
+	int lectores;			/* descriptores de lectura abiertos */
+	int escritores;			/* descriptores de escritura abiertos */
+	lista_BCPs lista_lectores;	/* bloqueados con la tuberia vacia */
+	lista_BCPs lista_escritores;	/* bloqueados con la tuberia llena */
+} tuberia;
+
+/*
+ * Espera de eventos - Nodo que apunta un proceso en una fuente. Se
+ * sacan de la cache de objetos y se enlazan en las dos direcciones
+ * para poder borrarlos sin recorrer la fuente.
+ */
+typedef struct nodo_espera_t {
+	BCP *proc;
+	struct nodo_espera_t *siguiente;
+	struct nodo_espera_t *anterior;
+	fuente_eventos *fuente;
+} nodo_espera;
+
+/*
+ * Traza - Evento de la traza de interrupciones y llamadas. Se ancla al
+ * proceso en ejecucion, a las llamadas que llevaba hechas y a las veces
+ * que habia pasado a ejecucion (pid -1 si el procesador estaba parado),
+ * de forma que al reproducirla se aplique en el mismo punto del
+ * proceso aunque el reloj real vaya a otro ritmo.
+ */
+typedef struct {
+	unsigned long tick;		/* marca de tiempo (informativa) */
+	int pid;
+	int llamadas;
+	int activaciones;
+	int tipo;			/* EV_RELOJ|EV_TERMINAL|EV_SW|EV_LLAMADA */
+	int dato;			/* caracter leido o numero de servicio */
+} evento_traza;
+
 /*
  * Variable global que identifica el proceso actual
  */
@@ -85,6 +242,106 @@ lista_BCPs lista_dormidos = {NULL, NULL};
  */
 lista_BCPs lista_espera = {NULL, NULL};
 
+/*
+ * Lista de procesos terminados cuya imagen y pila aun no se han liberado
+ */
+lista_BCPs lista_zombis = {NULL, NULL};
+
+/*
+ * Pila de un zombi recogido mientras el kernel aun ejecutaba sobre ella
+ * (desde espera_int); se libera en la siguiente pasada de recogida
+ */
+void *pila_diferida = NULL;
+
+/*
+ * Tiempo real - Tareas EDF que esperan el comienzo de su siguiente
+ * periodo, por haber acabado el trabajo o agotado el presupuesto. Las
+ * que estan listas van al principio de lista_listos, ordenadas por plazo.
+ */
+lista_BCPs lista_tiempo_real = {NULL, NULL};
+int utilizacion_tiempo_real = 0;	// suma de presupuesto/periodo (por mil)
+int expulsion_tiempo_real = 0;		// el proceso expulsado no pierde su turno
+
+/*
+ * Espera de eventos - Procesos bloqueados en esperar_eventos o
+ * leer_caracter y fuente de los caracteres del teclado
+ */
+lista_BCPs lista_eventos = {NULL, NULL};
+fuente_eventos fuente_teclado = {NULL, EVENTO_TECLADO};
+char buffer_teclado[TAM_BUF_TECLADO];
+int ini_teclado = 0;
+int num_teclado = 0;
+
+/*
+ * Asignador de objetos - Cada tipo de objeto dinamico del kernel tiene
+ * su cache. Los objetos se sacan de slabs de TAM_SLAB bytes tomados de
+ * una arena comun y los libres se encadenan en su propia memoria.
+ */
+typedef struct objeto_libre_t {
+	struct objeto_libre_t *siguiente;
+} objeto_libre;
+
+typedef struct {
+	char *nombre;
+	int tam_obj;			/* tam. redondeado a multiplo de long */
+	objeto_libre *libres;		/* objetos devueltos */
+	char *nuevo;			/* parte sin estrenar del ultimo slab */
+	int nuevos_restantes;		/* objetos que aun caben en el slab */
+	int num_slabs;
+	int en_uso;
+	int max_en_uso;
+	int asignaciones;
+	int fallos;			/* peticiones sin memoria en la arena */
+} cache_objetos;
+
+/*
+ * Variables globales que representan la arena y las caches registradas
+ */
+long arena_kernel[TAM_ARENA / sizeof(long)];
+int arena_usada = 0;
+cache_objetos *tabla_caches[MAX_CACHES];
+int num_caches = 0;
+
+long memoria_pilas = 0;		// pilas de los procesos aun no liberados
+
+/*
+ * Trabajo en espera - Pilas de TAM_PILA de reserva para crear_tarea,
+ * que el proceso nulo pone a cero por trozos
+ */
+typedef struct {
+	void *pila;
+	int limpios;		/* bytes ya puestos a cero desde el principio */
+} pila_reserva;
+
+pila_reserva reserva_pilas[TAM_RESERVA_PILAS];
+int num_reserva = 0;
+
+cache_objetos cache_tuberias;
+cache_objetos cache_nodos_espera;
+cache_objetos cache_perfiles;
+cache_objetos cache_anillos;
+
+/*
+ * Parametros - Tabla de parametros del kernel que se pueden cambiar en
+ * marcha dentro de su rango
+ */
+typedef struct {
+	char *nombre;
+	int valor;
+	int minimo;
+	int maximo;
+} parametro;
+
+parametro tabla_parametros[NUM_PARAMETROS]={
+	{"tick", TICK, TICK_MIN, TICK_MAX},
+	{"rodaja", TICKS_POR_RODAJA, 1, 1000},
+	{"vueltas_max", VUELTAS_MAX, 1, 100},
+	{"castigo", TICKS_CASTIGO, 1, 1000},
+	{"envejecimiento", UMBRAL_ENVEJECIMIENTO, 0, 10000},
+	{"periodo_reparto", PERIODO_REPARTO, 10, 10000}};
+
+#define PARAMETRO(n) (tabla_parametros[n].valor)
+
 /*
  *
  * Definicin del tipo que corresponde con una entrada en la tabla de
@@ -106,8 +363,56 @@ int get_pid();
 int sis_dormir();
 int get_ppid();
 int espera();
+int sis_crear_tuberia();
+int sis_leer_desc();
+int sis_escribir_desc();
+int sis_cerrar_desc();
+int sis_estadisticas_sistema();
+int sis_fijar_tiempo_real();
+int sis_esperar_periodo();
+int sis_alarma();
+int sis_temporizador();
+int sis_esperar_eventos();
+int sis_leer_caracter();
+int sis_crear_proceso_ext();
+int sis_memoria_sistema();
+int sis_leer_parametro();
+int sis_fijar_parametro();
+int sis_crear_proceso_args();
+int sis_argumentos();
+int sis_esperas_listos();
+int sis_iniciar_perfil();
+int sis_leer_perfil();
+int sis_fijar_holgura();
+int sis_ceder();
+int sis_ceder_a();
+int sis_crear_semaforo();
+int sis_crear_barrera();
+int sis_abrir_semaforo();
+int sis_cerrar_semaforo();
+int sis_bajar_semaforo();
+int sis_subir_semaforo();
+int sis_esperar_barrera();
+int sis_crear_grupo();
+int sis_fijar_grupo();
+int get_gid();
+int sis_matar_grupo();
+int sis_esperar_grupo();
+int sis_trazar();
+int sis_leer_traza();
+int sis_fijar_reparto();
+int sis_leer_reparto();
+int sis_procesar_lote();
+
+unsigned long ticks_sistema = 0;	// ticks de reloj desde el arranque
+int procesador_parado = 0;	// 1 mientras espera_int espera una interrupcion
+int modo_traza = MODO_TRAZA;	// TRAZA_NINGUNA|TRAZA_GRABAR|TRAZA_REPRODUCIR
+int evento_actual = 0;		// siguiente evento de la traza a reproducir
+
+estadisticas est_sistema;	// contadores globales (ESTADISTICAS_SISTEMA)
 
 int replanificacion_pendiente = 0; // 0 -> no hay pendiente, 1 -> hay planificacin pendiente 
+int cesion_pendiente = 0;	// el proceso que deja el procesador lo cede
   
 /*
  * Variable global que contiene las rutinas que realizan cada llamada
@@ -118,6 +423,46 @@ servicio tabla_servicios[NSERVICIOS]={	{sis_crear_proceso},
 					{get_pid},
 					{sis_dormir},
 					{get_ppid},
-					{espera}};
+					{espera},
+					{sis_crear_tuberia},
+					{sis_leer_desc},
+					{sis_escribir_desc},
+					{sis_cerrar_desc},
+					{sis_estadisticas_sistema},
+					{sis_fijar_tiempo_real},
+					{sis_esperar_periodo},
+					{sis_alarma},
+					{sis_temporizador},
+					{sis_esperar_eventos},
+					{sis_leer_caracter},
+					{sis_crear_proceso_ext},
+					{sis_memoria_sistema},
+					{sis_leer_parametro},
+					{sis_fijar_parametro},
+					{sis_crear_proceso_args},
+					{sis_argumentos},
+					{sis_esperas_listos},
+					{sis_iniciar_perfil},
+					{sis_leer_perfil},
+					{sis_fijar_holgura},
+					{sis_ceder},
+					{sis_ceder_a},
+					{sis_crear_semaforo},
+					{sis_crear_barrera},
+					{sis_abrir_semaforo},
+					{sis_cerrar_semaforo},
+					{sis_bajar_semaforo},
+					{sis_subir_semaforo},
+					{sis_esperar_barrera},
+					{sis_crear_grupo},
+					{sis_fijar_grupo},
+					{get_gid},
+					{sis_matar_grupo},
+					{sis_esperar_grupo},
+					{sis_trazar},
+					{sis_leer_traza},
+					{sis_fijar_reparto},
+					{sis_leer_reparto},
+					{sis_procesar_lote}};
 
 #endif /* _KERNEL_H */
\ No newline at end of file
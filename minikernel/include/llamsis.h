@@ -19,7 +19,7 @@
 #define _LLAMSIS_H
 
 /* Numero de llamadas disponibles */
-#define NSERVICIOS 7
+#define NSERVICIOS 47
 
 #define CREAR_PROCESO 0
 #define TERMINAR_PROCESO 1
@@ -28,6 +28,223 @@
 #define DORMIR 4
 #define GET_PPID 5
 #define ESPERA 6
+#define CREAR_TUBERIA 7
+#define LEER_DESC 8
+#define ESCRIBIR_DESC 9
+#define CERRAR_DESC 10
+#define ESTADISTICAS_SISTEMA 11
+#define FIJAR_TIEMPO_REAL 12
+#define ESPERAR_PERIODO 13
+#define ALARMA 14
+#define TEMPORIZADOR 15
+#define ESPERAR_EVENTOS 16
+#define LEER_CARACTER 17
+#define CREAR_PROCESO_EXT 18
+#define MEMORIA_SISTEMA 19
+#define LEER_PARAMETRO 20
+#define FIJAR_PARAMETRO 21
+#define CREAR_PROCESO_ARGS 22
+#define ARGUMENTOS 23
+#define ESPERAS_LISTOS 24
+#define INICIAR_PERFIL 25
+#define LEER_PERFIL 26
+#define FIJAR_HOLGURA 27
+#define CEDER 28
+#define CEDER_A 29
+#define CREAR_SEMAFORO 30
+#define CREAR_BARRERA 31
+#define ABRIR_SEMAFORO 32
+#define CERRAR_SEMAFORO 33
+#define BAJAR_SEMAFORO 34
+#define SUBIR_SEMAFORO 35
+#define ESPERAR_BARRERA 36
+#define CREAR_GRUPO 37
+#define FIJAR_GRUPO 38
+#define GET_GID 39
+#define MATAR_GRUPO 40
+#define ESPERAR_GRUPO 41
+#define TRAZAR 42
+#define LEER_TRAZA 43
+#define FIJAR_REPARTO 44
+#define LEER_REPARTO 45
+#define PROCESAR_LOTE 46
+
+/* Parametros del kernel que se leen y fijan en marcha */
+#define NUM_PARAMETROS 6
+#define PARAM_TICK 0		/* frecuencia del reloj (ticks/segundo) */
+#define PARAM_RODAJA 1		/* ticks por rodaja */
+#define PARAM_VUELTAS_MAX 2	/* rodajas agotadas antes del castigo */
+#define PARAM_CASTIGO 3		/* ticks que duerme el proceso castigado */
+#define PARAM_ENVEJECIMIENTO 4	/* ticks en listos antes de adelantarlo (0: nunca) */
+#define PARAM_PERIODO_REPARTO 5	/* ticks del periodo de las cuotas de grupo */
+
+/* Eventos que se pueden esperar con ESPERAR_EVENTOS */
+#define EVENTO_TECLADO 1	/* hay caracteres que leer */
+#define EVENTO_HIJO 2		/* ha terminado algun hijo */
+#define EVENTO_TIEMPO 4		/* ha vencido el plazo (solo en el resultado) */
+
+/* Modos de INICIAR_PERFIL (0 lo detiene) */
+#define PERFIL_PROCESO 1	/* muestrea al proceso que llama */
+#define PERFIL_HIJOS 2		/* y a los hijos que cree desde ahora */
+
+/* Mascara de TRAZAR: el bit n anota el servicio n (0 deja de trazar) */
+#define LLAMADA(n) (1UL << (n))
+#define TODAS_LLAMADAS (~0UL)
+
+/*
+ * Estadisticas del sistema que devuelve ESTADISTICAS_SISTEMA. Se
+ * comparte con la biblioteca de usuario.
+ */
+
+/* Causas de cambio de contexto; solo la expulsion es involuntaria */
+#define NUM_CAUSAS 6
+#define CAUSA_DORMIR 0
+#define CAUSA_ESPERA 1
+#define CAUSA_BLOQUEO 2		/* tuberias y demas listas de espera */
+#define CAUSA_FIN 3
+#define CAUSA_EXPULSION 4
+#define CAUSA_CEDER 5		/* ceder y ceder_a */
+
+#define NUM_VECTORES 6		/* el mismo valor que NVECTORES */
+#define VECTOR_LLAMSIS 4	/* el mismo valor que LLAM_SIS */
+
+/* La carga media va en coma fija con SHIFT_CARGA bits decimales */
+#define SHIFT_CARGA 16
+#define UNO_CARGA (1UL << SHIFT_CARGA)
+
+typedef struct {
+	unsigned long ticks;			/* desde el arranque */
+	unsigned long cambios[NUM_CAUSAS];
+	unsigned long llamadas[NSERVICIOS];
+	unsigned long interrupciones[NUM_VECTORES];
+	int listos;			/* cola de listos en la ultima muestra */
+	unsigned long carga[3];		/* media de listos en 1, 5 y 15 s */
+	unsigned long pasadas_despertar;	/* ticks en que se desperto a alguien */
+	unsigned long despertados;	/* procesos despertados en ellas */
+} estadisticas;
+
+/* Uso de una cache de objetos del kernel (dentro de info_memoria) */
+#define NUM_CACHES_INFO 8	/* el mismo valor que MAX_CACHES */
+#define MAX_NOMBRE_CACHE 20
+
+typedef struct {
+	char nombre[MAX_NOMBRE_CACHE];
+	int tam_obj;		/* bytes por objeto */
+	int slabs;
+	int en_uso;
+	int max_en_uso;
+	int asignaciones;
+	int fallos;		/* peticiones sin memoria en la arena */
+} info_cache;
+
+/* Memoria que ocupa el sistema, en bytes (llamada MEMORIA_SISTEMA) */
+typedef struct {
+	int procesos;		/* entradas ocupadas de la tabla, zombis incluidos */
+	long pilas;		/* pilas de esos procesos */
+	long proceso;		/* pilas del proceso que llama */
+	long reserva;		/* pilas de reserva para nuevos procesos */
+	long tabla_procesos;	/* tabla de procesos */
+	long arena;		/* arena de objetos del kernel */
+	long arena_usada;	/* parte de la arena ya repartida en slabs */
+	long objetos;		/* objetos del kernel en uso */
+	int num_caches;
+	info_cache caches[NUM_CACHES_INFO];
+} info_memoria;
+
+/* Espera en la cola de listos de un proceso, en ticks (ESPERAS_LISTOS) */
+typedef struct {
+	int id;
+	int estado;
+	unsigned long veces;	/* veces que ha pasado de listo a ejecucion */
+	unsigned long media;	/* espera media de esas veces */
+	unsigned long maxima;	/* incluye la espera en curso si esta listo */
+	unsigned long envejecimientos;	/* veces que se le ha adelantado */
+} info_espera;
+
+/*
+ * Perfil de un proceso (LEER_PERFIL): muestras del PC tomadas en cada
+ * tick. Las cubetas cubren el codigo de la imagen, [inicio, fin) desde
+ * su dir. de carga base, con 2^desplazamiento bytes cada una.
+ */
+#define NUM_CUBETAS_PERFIL 256
+
+typedef struct {
+	unsigned long base;
+	unsigned long inicio;
+	unsigned long fin;
+	int desplazamiento;
+	unsigned long muestras;		/* ticks en ejecucion */
+	unsigned long en_kernel;	/* de ellos, dentro del kernel */
+	unsigned long fuera;		/* en modo usuario fuera de la imagen */
+	unsigned int cubetas[NUM_CUBETAS_PERFIL];
+} info_perfil;
+
+/* Reparto del procesador entre grupos (FIJAR_REPARTO) */
+#define PESO_DEFECTO 10
+#define PESO_MAX 1000
+
+/*
+ * Reparto de un grupo (LEER_REPARTO). Entre los grupos con procesos
+ * listos ejecuta el que menos procesador ha recibido en el periodo en
+ * proporcion a su peso; con cuota, el grupo no ejecuta mas de esos
+ * ticks por periodo aunque el procesador quede libre.
+ */
+typedef struct {
+	int peso;
+	int cuota;			/* ticks por periodo (0: sin limite) */
+	int miembros;
+	unsigned long uso;		/* ticks en el periodo en curso */
+	unsigned long total;		/* ticks desde que se creo el grupo */
+	unsigned long estrangulamientos;	/* periodos en que agoto la cuota */
+} info_reparto;
+
+/*
+ * Llamada de un proceso trazado (LEER_TRAZA): argumentos de los
+ * registros 1 a 5 y ticks de entrada y salida. num cuenta las llamadas
+ * anotadas desde TRAZAR; un salto indica registros que se perdieron
+ * porque nadie los leyo antes de llenarse el anillo.
+ */
+#define NUM_ARGS_TRAZA 5
+
+typedef struct {
+	unsigned long num;
+	int servicio;
+	long args[NUM_ARGS_TRAZA];
+	long resultado;
+	unsigned long entrada;
+	unsigned long salida;
+} info_llamada;
+
+/*
+ * Anillo de peticiones por lotes (PROCESAR_LOTE), en la memoria del
+ * proceso. El proceso encola peticiones en envios avanzando envio_cola;
+ * el kernel las ejecuta en orden desde envio_cabeza y deja cada
+ * resultado en fines, con el dato de su peticion, avanzando fin_cola;
+ * el proceso los recoge avanzando fin_cabeza. Los indices solo crecen
+ * y la posicion es el indice modulo TAM_ANILLO_LOTE.
+ */
+#define TAM_ANILLO_LOTE 64
+#define NUM_ARGS_LOTE 5
+
+typedef struct {
+	int servicio;
+	long args[NUM_ARGS_LOTE];
+	long dato;		/* del proceso: vuelve con el resultado */
+} peticion_lote;
+
+typedef struct {
+	long dato;
+	long resultado;
+} fin_lote;
+
+typedef struct {
+	unsigned int envio_cabeza;
+	unsigned int envio_cola;
+	unsigned int fin_cabeza;
+	unsigned int fin_cola;
+	peticion_lote envios[TAM_ANILLO_LOTE];
+	fin_lote fines[TAM_ANILLO_LOTE];
+} anillo_lote;
 
 #endif /* _LLAMSIS_H */
 
@@ -0,0 +1,13 @@
+/*
+ *  minikernel/include/traza.h
+ *
+ * Traza de eventos que reproduce el kernel cuando se compila con
+ * MODO_TRAZA=TRAZA_REPRODUCIR. Se genera con minikernel/traza.sh a
+ * partir de la salida de una ejecucion compilada con
+ * MODO_TRAZA=TRAZA_GRABAR. La version inicial esta vacia.
+ *
+ */
+
+evento_traza traza_reproduccion[] = {
+	{0, 0, 0, 0, EV_FIN, 0}
+};
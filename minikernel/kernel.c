@@ -13,9 +13,84 @@
  *
  */
 
+#define _GNU_SOURCE	/* REG_RIP, dlinfo y dl_iterate_phdr para el perfil */
+
 #include "kernel.h"	/* Contiene defs. usadas por este modulo */
+#include "traza.h"	/* Traza que se reproduce con MODO_TRAZA=TRAZA_REPRODUCIR */
+#include <dlfcn.h>	/* dlsym: el HAL no busca otros simbolos de la imagen */
+#include <link.h>	/* segmentos de la imagen que cubre el perfil */
+
+
+
+/*
+ *
+ * Funciones del asignador de objetos del kernel:
+ *	iniciar_cache reservar_objeto liberar_objeto
+ *
+ */
+
+/*
+ * Prepara una cache vacia para objetos de tam bytes y la registra
+ */
+static void iniciar_cache(cache_objetos *cache, char *nombre, int tam){
+	if (tam > TAM_SLAB)
+		panico("objeto del kernel mayor que un slab");
+	cache->nombre = nombre;
+	cache->tam_obj = ((tam + sizeof(long) - 1) / sizeof(long)) * sizeof(long);
+	cache->libres = NULL;
+	cache->nuevo = NULL;
+	cache->nuevos_restantes = 0;
+	cache->num_slabs = 0;
+	cache->en_uso = 0;
+	cache->max_en_uso = 0;
+	cache->asignaciones = 0;
+	cache->fallos = 0;
+	if (num_caches < MAX_CACHES)
+		tabla_caches[num_caches++] = cache;
+}
+
+/*
+ * Devuelve un objeto de la cache en tiempo constante: reutiliza uno
+ * libre, estrena el siguiente del slab actual o toma un slab nuevo de
+ * la arena. NULL si la arena esta agotada.
+ */
+static void * reservar_objeto(cache_objetos *cache){
+	void *obj;
+
+	if (cache->libres != NULL){
+		obj = cache->libres;
+		cache->libres = cache->libres->siguiente;
+	} else {
+		if (cache->nuevos_restantes == 0){
+			if (arena_usada + TAM_SLAB > sizeof(arena_kernel)){
+				cache->fallos++;
+				return NULL;
+			}
+			cache->nuevo = (char *)arena_kernel + arena_usada;
+			cache->nuevos_restantes = TAM_SLAB / cache->tam_obj;
+			arena_usada += TAM_SLAB;
+			cache->num_slabs++;
+		}
+		obj = cache->nuevo;
+		cache->nuevo += cache->tam_obj;
+		cache->nuevos_restantes--;
+	}
+	cache->asignaciones++;
+	if (++(cache->en_uso) > cache->max_en_uso)
+		cache->max_en_uso = cache->en_uso;
+	return obj;
+}
 
+/*
+ * Devuelve un objeto a su cache
+ */
+static void liberar_objeto(cache_objetos *cache, void *obj){
+	objeto_libre *libre = (objeto_libre *)obj;
 
+	libre->siguiente = cache->libres;
+	cache->libres = libre;
+	cache->en_uso--;
+}
 
 /*
 * Practica 1 - Mostrar la llista de processos
@@ -40,6 +115,8 @@ static void muestra_todas_listas(){
 	muestra_lista(&lista_dormidos);
 	printk("ESPERANDO:");
 	muestra_lista(&lista_espera);
+	printk("ZOMBIS:");
+	muestra_lista(&lista_zombis);
 	printk("\n");
 }
 
@@ -51,7 +128,7 @@ static void print_prueba(){
 /*
  *
  * Funciones relacionadas con la tabla de procesos:
- *	iniciar_tabla_proc buscar_BCP_libre
+ *	iniciar_tabla_proc buscar_BCP_libre (mas abajo, junto a recoger_zombis)
  *
  */
 
@@ -65,22 +142,12 @@ static void iniciar_tabla_proc(){
 		tabla_procs[i].estado=NO_USADA;
 }
 
-/*
- * Funcin que busca una entrada libre en la tabla de procesos
- */
-static int buscar_BCP_libre(){
-	int i;
-
-	for (i=0; i<MAX_PROC; i++)
-		if (tabla_procs[i].estado==NO_USADA)
-			return i;
-	return -1;
-}
 
 /*
  *
  * Funciones que facilitan el manejo de las listas de BCPs
- *	insertar_ultimo eliminar_primero eliminar_elem
+ *	insertar_ultimo insertar_segundo insertar_tras
+ *	eliminar_primero eliminar_elem
  *
  * NOTA: PRIMERO SE DEBE LLAMAR A eliminar Y LUEGO A insertar
  */
@@ -116,6 +183,21 @@ static void insertar_segundo(lista_BCPs *lista, BCP * proc){
 	}
 }
 
+/*
+ * Inserta un BCP detras de otro de la lista (al principio si ant es NULL).
+ */
+static void insertar_tras(lista_BCPs *lista, BCP *ant, BCP * proc){
+	if (ant == NULL){
+		proc->siguiente = lista->primero;
+		lista->primero = proc;
+	} else {
+		proc->siguiente = ant->siguiente;
+		ant->siguiente = proc;
+	}
+	if (proc->siguiente == NULL)
+		lista->ultimo = proc;
+}
+
 /*
  * Elimina el primer BCP de la lista.
  */
@@ -148,382 +230,2829 @@ static void eliminar_elem(lista_BCPs *lista, BCP * proc){
 
 /*
  *
- * Funciones relacionadas con la planificacion
- *	espera_int planificador
+ * Funciones relacionadas con el trabajo en espera:
+ *	tomar_pila devolver_pila trabajo_en_espera
+ *
  */
 
 /*
- * Espera a que se produzca una interrupcion
+ * Devuelve una pila de tam bytes, de la reserva si ya esta limpia
  */
-static void espera_int(){
-	int nivel;
-
-	printk("-> NO HAY LISTOS. ESPERA INT\n");
+static void * tomar_pila(int tam){
+	void *pila;
+	int i;
 
-	/* Baja al mnimo el nivel de interrupcin mientras espera */
-	nivel=fijar_nivel_int(NIVEL_1);
-	halt();
-	fijar_nivel_int(nivel);
+	if (tam == TAM_PILA)
+		for (i=0; i<num_reserva; i++)
+			if (reserva_pilas[i].limpios == TAM_PILA){
+				pila = reserva_pilas[i].pila;
+				reserva_pilas[i] = reserva_pilas[--num_reserva];
+				return pila;
+			}
+	return crear_pila(tam);
 }
 
 /*
- * Funcin de planificacion que implementa un algoritmo FIFO.
+ * Guarda en la reserva, sin limpiar, la pila de un proceso terminado
  */
-static BCP * planificador(){
-	while (lista_listos.primero==NULL)
-		espera_int();		/* No hay nada que hacer */
-	return lista_listos.primero;
+static void devolver_pila(void *pila, int tam){
+	if (tam == TAM_PILA && num_reserva < TAM_RESERVA_PILAS){
+		reserva_pilas[num_reserva].pila = pila;
+		reserva_pilas[num_reserva].limpios = 0;
+		num_reserva++;
+	} else
+		liberar_pila(pila);
 }
 
 /*
-* Practica 1 - Desbloquear procesos
-*/
-static void desbloquear (BCP* proc, lista_BCPs* lista){
-	(proc->estado) = LISTO;
-	eliminar_elem(lista, proc);
-	if ((proc->rodaja) > 0){
-		insertar_segundo(&lista_listos, proc);
-	} else {
-		(proc->rodaja) = TICKS_POR_RODAJA;
-		insertar_ultimo(&lista_listos, proc);
+ * Hace una unidad de trabajo de preparacion: poner a cero un trozo de
+ * una pila de reserva o crear una pila de reserva. Devuelve 0 si no
+ * queda nada por hacer.
+ */
+static int trabajo_en_espera(){
+	long *trozo;
+	int i, j;
+
+	for (i=0; i<num_reserva; i++)
+		if (reserva_pilas[i].limpios < TAM_PILA){
+			trozo = (long *)((char *)reserva_pilas[i].pila +
+				reserva_pilas[i].limpios);
+			for (j=0; j<TAM_TROZO_CERO/sizeof(long); j++)
+				trozo[j] = 0;
+			reserva_pilas[i].limpios += TAM_TROZO_CERO;
+			return 1;
+		}
+	if (num_reserva < TAM_RESERVA_PILAS){
+		reserva_pilas[num_reserva].pila = crear_pila(TAM_PILA);
+		if (reserva_pilas[num_reserva].pila != NULL){
+			reserva_pilas[num_reserva++].limpios = 0;
+			return 1;
+		}
 	}
+	return 0;
 }
 
-/**
- * Practica 3 - Tratar el padre
+/*
+ *
+ * Funciones relacionadas con los procesos terminados:
+ *	adoptar_huerfanos pila_en_uso recoger_zombis buscar_BCP_libre
+ *
  */
-static void tratar_padre(){
-	tabla_procs[p_proc_actual->ppid].num_hijos--;
-	
-	if (p_proc_actual->id != 0 &&
-	  (tabla_procs[p_proc_actual->ppid].num_hijos <= 0) && 
-	  (tabla_procs[p_proc_actual->ppid].estado == ESPERANDO)){
-		desbloquear(&tabla_procs[p_proc_actual->ppid], &lista_espera);
-	}
+
+/*
+ * Reasigna a init los hijos del proceso que termina. Se hace al
+ * terminar y no al recogerlo para que ningun hijo apunte a un zombi.
+ */
+static void adoptar_huerfanos(BCP *proc){
+	int i;
+
+	for (i=0; i<MAX_PROC; i++)
+		if (tabla_procs[i].ppid == proc->id &&
+		    tabla_procs[i].estado != NO_USADA)
+			tabla_procs[i].ppid = 0;
 }
 
 /*
- * Practica 2 - Cambios de contexto voluntarios e involuntarios
- * Antes se llamaba bloquear -> para dormir procesos
- * Ahora debe hacer ms cosas
+ * Pila sobre la que ejecuta el proceso en modo sistema
  */
-static void cambio_proceso (lista_BCPs* lista){
-	int nivel = fijar_nivel_int(NIVEL_3);
-	
-	BCP* proc = p_proc_actual;
-	
-	eliminar_primero(&lista_listos);
-		
-	if(lista == &lista_dormidos){ // Dormir
-		(proc->estado)=BLOQUEADO;
-		insertar_ultimo(lista,proc);
-	}
-	else if(lista == &lista_espera){ // Espera
-		(proc->estado)=ESPERANDO;
-		insertar_ultimo(lista,proc);
-	}
-	else if(lista == &lista_listos){ // Cambio
-		(proc->estado)=LISTO;
-		insertar_ultimo(lista,proc);
+static void * pila_en_uso(BCP *proc){
+	return proc->en_alarma ? proc->pila_alarma : proc->pila;
+}
+
+/*
+ * Libera los recursos de como mucho max procesos zombis: la pila y por
+ * ultimo la imagen (al liberar la ultima imagen el HAL da por terminado
+ * el sistema)
+ */
+static void recoger_zombis(int max){
+	BCP *proc;
+
+	/* la pila del que termino antes ya no es la que se esta usando */
+	if (pila_diferida != NULL && pila_diferida != pila_en_uso(p_proc_actual)){
+		liberar_pila(pila_diferida);
+		pila_diferida = NULL;
 	}
-	else if(lista == NULL){ // Liberar
-		liberar_imagen(proc->info_mem); 
-		(proc->estado)=TERMINADO;
-		tratar_padre();
-		int i;
-		for (i=0; i<MAX_PROC; i++){
-			if((tabla_procs[i].ppid == proc->id) && (tabla_procs[i].estado != TERMINADO)){
-				tabla_procs[i].ppid = 0;
-			}
-		}
-		liberar_pila(proc->pila);
+	while (max-- > 0 && lista_zombis.primero != NULL){
+		proc = lista_zombis.primero;
+		eliminar_primero(&lista_zombis);
+		/* desde espera_int se sigue ejecutando en la pila del
+		   ultimo proceso que dejo el procesador (la del manejador
+		   si termino dentro de el): no se puede liberar todavia,
+		   porque crear_pila podria devolverla a trabajo_en_espera
+		   y este la pondria a cero */
+		if (proc == p_proc_actual)
+			pila_diferida = pila_en_uso(proc);
+		if (proc->pila != pila_diferida)
+			devolver_pila(proc->pila, proc->tam_pila);
+		if (proc->pila_alarma != NULL && proc->pila_alarma != pila_diferida)
+			liberar_pila(proc->pila_alarma);
+		memoria_pilas -= proc->memoria;
+		proc->estado = NO_USADA;
+		liberar_imagen(proc->info_mem);
 	}
-	
-	p_proc_actual = planificador();
-	(p_proc_actual->estado) = EJECUCION;
-	
-	printk("-> C.CONTEXTO POR FIN: de %d a %d\n",
-		proc->id, p_proc_actual->id);
-	
-	fijar_nivel_int(nivel);
-	
-	if (lista != NULL){
-		cambio_contexto(&(proc->contexto_regs), &(p_proc_actual->contexto_regs));
-	} else {
-		cambio_contexto(NULL, &(p_proc_actual->contexto_regs));
+}
+
+/*
+ * Funcin que busca una entrada libre en la tabla de procesos. Si estan
+ * todas ocupadas recoge los zombis pendientes antes de rendirse.
+ */
+static int buscar_BCP_libre(){
+	int i;
+
+	for (i=0; i<MAX_PROC; i++)
+		if (tabla_procs[i].estado==NO_USADA)
+			return i;
+	if (lista_zombis.primero != NULL){
+		recoger_zombis(MAX_PROC);
+		return buscar_BCP_libre();
 	}
+	return -1;
 }
 
 /*
  *
- * Funcion auxiliar que termina proceso actual liberando sus recursos.
- * Usada por llamada terminar_proceso y por rutinas que tratan excepciones
+ * Funciones del perfil de ejecucion:
+ *	buscar_codigo crear_perfil liberar_perfil pc_interrumpido
+ *	muestrear_perfil
+ *
+ * Cada tick se anota el PC interrumpido del proceso en ejecucion en
+ * una cubeta de su perfil. Al liberarse el perfil se vuelca como
+ * lineas "#PERFIL" y "#CUBETA" que resuelve minikernel/perfil.sh.
  *
  */
-static void liberar_proceso(){
-	cambio_proceso(NULL);
-}
 
 /*
-* Practica 1 - Ajustar Dormidos
-*/
-static void ajustar_dormidos (){
-	BCP* head = lista_dormidos.primero;
-	while(head != NULL){
-		(head->ticks)--;
-		BCP* head2 = head->siguiente;
-		if ((head->ticks) == 0){
-			desbloquear(head, &lista_dormidos);
+ * Callback de dl_iterate_phdr: anota en el perfil el segmento
+ * ejecutable del objeto cargado en perfil->base
+ */
+static int buscar_codigo(struct dl_phdr_info *info, size_t tam, void *datos){
+	info_perfil *perfil = (info_perfil *)datos;
+	int i;
+
+	if (info->dlpi_addr != perfil->base)
+		return 0;
+	for (i=0; i<info->dlpi_phnum; i++)
+		if (info->dlpi_phdr[i].p_type == PT_LOAD &&
+		    (info->dlpi_phdr[i].p_flags & PF_X)){
+			perfil->inicio = info->dlpi_phdr[i].p_vaddr;
+			perfil->fin = perfil->inicio + info->dlpi_phdr[i].p_memsz;
+			return 1;
 		}
-		head = head2;
-	}
+	return 0;
 }
 
 /*
- * Practica 2 - Actualiza la rodaja de tiempo y al final de esta, ejecuta una interrupcin de software
+ * Asigna al proceso un perfil vacio que cubre el codigo de su imagen.
+ * Si ya tenia uno lo pone a cero. Devuelve -1 si no hay memoria.
  */
-static void actualizar_rodaja(){
-	if (p_proc_actual != NULL && (p_proc_actual->estado) == EJECUCION){
-		(p_proc_actual->rodaja)--;
-		if ((p_proc_actual->rodaja)<=0){
-			replanificacion_pendiente = 1;
-			activar_int_SW();
-		}
+static int crear_perfil(BCP *proc){
+	struct link_map *mapa;
+	info_perfil *perfil = proc->perfil;
+	int i;
+
+	if (perfil == NULL && (perfil = reservar_objeto(&cache_perfiles)) == NULL)
+		return -1;
+	perfil->base = perfil->inicio = perfil->fin = 0;
+	if (dlinfo(proc->info_mem, RTLD_DI_LINKMAP, &mapa) == 0){
+		perfil->base = mapa->l_addr;
+		dl_iterate_phdr(buscar_codigo, perfil);
 	}
+	for (perfil->desplazamiento = 0;
+	     perfil->fin > perfil->inicio &&
+	     ((perfil->fin - perfil->inicio - 1) >> perfil->desplazamiento) >=
+		NUM_CUBETAS_PERFIL;
+	     perfil->desplazamiento++);
+	perfil->muestras = perfil->en_kernel = perfil->fuera = 0;
+	for (i=0; i<NUM_CUBETAS_PERFIL; i++)
+		perfil->cubetas[i] = 0;
+	proc->perfil = perfil;
+	return 0;
 }
 
 /*
- *
- * Funciones relacionadas con el tratamiento de interrupciones
- *	excepciones: exc_arit exc_mem
- *	interrupciones de reloj: int_reloj
- *	interrupciones del terminal: int_terminal
- *	llamadas al sistemas: llam_sis
- *	interrupciones SW: int_sw
- *
+ * Vuelca el perfil del proceso, con las direcciones relativas a la
+ * base de la imagen, y lo devuelve a su cache
  */
+static void liberar_perfil(BCP *proc){
+	info_perfil *perfil = proc->perfil;
+	struct link_map *mapa;
+	unsigned long desde;
+	int i;
+
+	if (perfil == NULL)
+		return;
+	printk("#PERFIL %d %s %lu %lu %lu\n", proc->id,
+		dlinfo(proc->info_mem, RTLD_DI_LINKMAP, &mapa) == 0 ?
+		mapa->l_name : "?", perfil->muestras, perfil->en_kernel,
+		perfil->fuera);
+	for (i=0; i<NUM_CUBETAS_PERFIL; i++){
+		if (perfil->cubetas[i] == 0)
+			continue;
+		desde = perfil->inicio + ((unsigned long)i << perfil->desplazamiento);
+		printk("#CUBETA %d %lx %lx %u\n", proc->id, desde,
+			desde + (1UL << perfil->desplazamiento), perfil->cubetas[i]);
+	}
+	liberar_objeto(&cache_perfiles, perfil);
+	proc->perfil = NULL;
+}
 
 /*
- * Tratamiento de excepciones aritmeticas
+ * PC interrumpido por la senal del reloj. marco es el puntero de marco
+ * del preludio del HAL que llamo a int_reloj: es el manejador de la
+ * senal, asi que sobre su direccion de retorno esta el ucontext que
+ * guarda Linux (rt_sigframe). Solo vale en x86_64 y con punteros de
+ * marco; en otro caso las muestras cuentan como fuera de la imagen.
  */
-static void exc_arit(){
+static unsigned long pc_interrumpido(void *marco){
+#if defined(__x86_64__)
+	ucontext_t *uc = (ucontext_t *)((void **)marco + 2);
 
-	if (!viene_de_modo_usuario())
-		panico("excepcion aritmetica cuando estaba dentro del kernel");
+	return uc->uc_mcontext.gregs[REG_RIP];
+#else
+	return 0;
+#endif
+}
 
+/*
+ * Anota una muestra en el perfil del proceso en ejecucion
+ */
+static void muestrear_perfil(void *marco){
+	info_perfil *perfil;
+	unsigned long pc;
+
+	if (p_proc_actual == NULL || p_proc_actual->estado != EJECUCION ||
+	    (perfil = p_proc_actual->perfil) == NULL)
+		return;
+	perfil->muestras++;
+	if (!viene_de_modo_usuario()){
+		perfil->en_kernel++;
+		return;
+	}
+	pc = pc_interrumpido(marco) - perfil->base;
+	if (pc < perfil->inicio || pc >= perfil->fin){
+		perfil->fuera++;
+		return;
+	}
+	perfil->cubetas[(pc - perfil->inicio) >> perfil->desplazamiento]++;
+}
 
-	printk("-> EXCEPCION ARITMETICA EN PROC %d\n", p_proc_actual->id);
-	liberar_proceso();
+/*
+ *
+ * Funciones de la traza de llamadas al sistema:
+ *	anotar_llamada liberar_anillo inicio_llamada fin_llamada
+ *
+ * Solo los procesos con anillo pagan algo en tratar_llamsis; para los
+ * demas cuesta comprobar un puntero. Las llamadas que nadie ha leido
+ * al liberarse el anillo se vuelcan como lineas "#LLAMADA".
+ *
+ */
 
-        return; /* no debera llegar aqui */
+/*
+ * Guarda la llamada en el anillo, pisando la mas antigua si esta
+ * lleno. Hay que llamarla a NIVEL_3: leer_traza lo vacia desde otro
+ * proceso.
+ */
+static void anotar_llamada(anillo_llamadas *anillo, info_llamada *llamada){
+	llamada->num = anillo->anotadas++;
+	if (anillo->num == TAM_ANILLO_LLAMADAS){
+		anillo->primera = (anillo->primera + 1) % TAM_ANILLO_LLAMADAS;
+		anillo->num--;
+	}
+	anillo->registros[(anillo->primera + anillo->num) %
+		TAM_ANILLO_LLAMADAS] = *llamada;
+	anillo->num++;
 }
 
 /*
- * Tratamiento de excepciones en el acceso a memoria
+ * Vuelca las llamadas sin leer del proceso y devuelve el anillo a su
+ * cache
  */
-static void exc_mem(){
+static void liberar_anillo(BCP *proc){
+	anillo_llamadas *anillo = proc->llamadas;
+	info_llamada *llamada;
+	int i;
 
-	if (!viene_de_modo_usuario())
-		panico("excepcion de memoria cuando estaba dentro del kernel");
+	if (anillo == NULL)
+		return;
+	for (i=0; i<anillo->num; i++){
+		llamada = &anillo->registros[(anillo->primera + i) %
+			TAM_ANILLO_LLAMADAS];
+		printk("#LLAMADA %d %lu %d %lx %lx %lx %ld %lu %lu\n", proc->id,
+			llamada->num, llamada->servicio, llamada->args[0],
+			llamada->args[1], llamada->args[2], llamada->resultado,
+			llamada->entrada, llamada->salida);
+	}
+	liberar_objeto(&cache_anillos, anillo);
+	proc->llamadas = NULL;
+}
 
+/*
+ * Si la mascara del proceso en ejecucion incluye el servicio, apunta
+ * sus argumentos y el tick de entrada y devuelve 1. Se llama a NIVEL_3
+ * para que no se libere el anillo entretanto.
+ */
+static int inicio_llamada(info_llamada *llamada, int nserv){
+	int i;
 
-	printk("-> EXCEPCION DE MEMORIA EN PROC %d\n", p_proc_actual->id);
-	liberar_proceso();
+	if (nserv < 0 || nserv >= NSERVICIOS ||
+	    !(p_proc_actual->llamadas->mascara & LLAMADA(nserv)))
+		return 0;
+	llamada->servicio = nserv;
+	for (i=0; i<NUM_ARGS_TRAZA; i++)
+		llamada->args[i] = leer_registro(i + 1);
+	llamada->entrada = ticks_sistema;
+	return 1;
+}
 
-        return; /* no debera llegar aqui */
+/*
+ * Completa la llamada con su resultado y la anota. Terminar_proceso no
+ * vuelve y no se anota; si durante la llamada se dejo de trazar al
+ * proceso, tampoco.
+ */
+static void fin_llamada(info_llamada *llamada, int res){
+	int nivel;
+
+	llamada->resultado = res;
+	llamada->salida = ticks_sistema;
+	nivel = fijar_nivel_int(NIVEL_3);
+	if (p_proc_actual->llamadas != NULL)
+		anotar_llamada(p_proc_actual->llamadas, llamada);
+	fijar_nivel_int(nivel);
 }
 
 /*
- * Tratamiento de interrupciones de terminal
+ * Registro y reproduccion de la traza (definidas mas abajo)
  */
-static void int_terminal(){
+static void registrar_evento(int tipo, int dato);
+static int reproducir_eventos();
+static void traza_llamada(int nserv);
+static void divergencia();
 
-	printk("-> TRATANDO INT. DE TERMINAL %c\n", leer_puerto(DIR_TERMINAL));
+/*
+ *
+ * Funciones relacionadas con la planificacion
+ *	espera_int planificador
+ */
 
-        return;
+/*
+ * Reparto - Indica si el proceso no puede ejecutar porque su grupo ha
+ * agotado la cuota del periodo. Las tareas EDF no se limitan.
+ */
+static int estrangulado(BCP *proc){
+	return !proc->tiempo_real && tabla_grupos[proc->gid].estrangulado;
 }
 
 /*
- * Tratamiento de interrupciones de reloj
+ * Reparto - Indica si el grupo a ha recibido en el periodo menos
+ * procesador que b en proporcion a su peso
  */
-static void int_reloj(){  
-	printk("-> TRATANDO INT. DE reloj \n");
-	actualizar_rodaja();
-	ajustar_dormidos();
+static int menos_servido(grupo *a, grupo *b){
+	return a->uso * b->peso < b->uso * a->peso;
 }
 
 /*
- * Tratamiento de llamadas al sistema
+ * Reparto - Indica si hay algun listo que pueda ejecutar
  */
-static void tratar_llamsis(){
-	int nserv, res;
-
-	nserv=leer_registro(0);
-	if (nserv<NSERVICIOS)
-		res=(tabla_servicios[nserv].fservicio)();
-	else
-		res=-1;		/* servicio no existente */
-	escribir_registro(0,res);
-	return;
+static int hay_listo_elegible(){
+	BCP *proc;
+	int nivel, hay = 0;
+
+	nivel = fijar_nivel_int(NIVEL_3);
+	for (proc = lista_listos.primero; proc != NULL && !hay;
+	     proc = proc->siguiente)
+		hay = !estrangulado(proc);
+	fijar_nivel_int(nivel);
+	return hay;
 }
 
 /*
- * Tratamiento de interrupciuones software
+ * Reparto - Pone en cabeza de lista_listos al proceso que debe
+ * ejecutar. Las tareas EDF y los envejecidos ya estan delante y se
+ * respetan; tras una cesion tambien el primero que les sigue, que es
+ * el destino de ceder_a. Entre los procesos normales se elige el
+ * primero del grupo menos servido, asi que dentro de cada grupo sigue
+ * siendo FIFO. Los estrangulados se saltan; NULL si no queda ninguno.
  */
-static void int_sw(){
-	printk("-> TRATANDO INT. SW\n");
-	if (replanificacion_pendiente == 1){
-		if((p_proc_actual->siguiente) == NULL){
-			(p_proc_actual->rodaja) = TICKS_POR_RODAJA;
-		} else {
-			(p_proc_actual->vueltas)++;
-			if ((p_proc_actual->vueltas) >= VUELTAS_MAX){
-				(p_proc_actual->vueltas) = VUELTAS_INIT;
-				(p_proc_actual->ticks) = (TICKS_POR_RODAJA * 3) / 4;
-				cambio_proceso(&lista_dormidos);
-			} else {
-				(p_proc_actual->rodaja) = TICKS_POR_RODAJA / 2;
-				cambio_proceso(&lista_listos);
-			}
+static BCP * elegir_listo(){
+	BCP *proc, *elegido = NULL;
+
+	for (proc = lista_listos.primero; proc != NULL; proc = proc->siguiente){
+		if (estrangulado(proc))
+			continue;
+		if (elegido == NULL && (proc->tiempo_real || proc->envejecido ||
+		    cesion_pendiente)){
+			elegido = proc;
+			break;
 		}
+		if (elegido == NULL || menos_servido(&tabla_grupos[proc->gid],
+		    &tabla_grupos[elegido->gid]))
+			elegido = proc;
 	}
-	return;
+	if (elegido != NULL && elegido != lista_listos.primero){
+		eliminar_elem(&lista_listos, elegido);
+		insertar_tras(&lista_listos, NULL, elegido);
+	}
+	return elegido;
+}
+
+/*
+ * Espera a que se produzca una interrupcion. Aprovecha para liberar
+ * algunos de los procesos terminados y poner a cero pilas de reserva
+ * para los proximos crear_tarea.
+ */
+static void espera_int(){
+	int nivel;
+
+	printk("-> NO HAY LISTOS. ESPERA INT\n");
+
+	recoger_zombis(ZOMBIS_POR_PASADA);
+
+	procesador_parado = 1;
+	/* Al reproducir, la interrupcion que se espera sale de la traza */
+	if (modo_traza == TRAZA_REPRODUCIR && reproducir_eventos() == 0)
+		divergencia();
+	if (modo_traza != TRAZA_REPRODUCIR){
+		/* Baja al mnimo el nivel de interrupcin mientras espera */
+		nivel=fijar_nivel_int(NIVEL_1);
+		/* prepara trabajo por unidades acotadas mientras no haya
+		   listos; las interrupciones pueden llegar entre unidades */
+		while (!hay_listo_elegible() && trabajo_en_espera());
+		if (!hay_listo_elegible())
+			halt();
+		fijar_nivel_int(nivel);
+	}
+	procesador_parado = 0;
+}
+
+/*
+ * Funcin de planificacion que implementa un algoritmo FIFO dentro de
+ * cada grupo y reparte el procesador entre grupos segun su peso.
+ */
+static BCP * planificador(){
+	BCP *proc;
+
+	while ((proc = elegir_listo()) == NULL)
+		espera_int();		/* No hay nada que hacer */
+	return proc;
+}
+
+/*
+ * Tiempo real - Utilizacion de una tarea en tanto por mil, redondeada
+ * hacia arriba para no admitir de mas
+ */
+static int utilizacion(int periodo, int presupuesto){
+	return (presupuesto * 1000 + periodo - 1) / periodo;
+}
+
+/*
+ * Tiempo real - Inserta una tarea EDF en lista_listos por orden de
+ * plazo, detras de las de plazo menor o igual. El proceso en ejecucion
+ * sigue en cabeza hasta que se le expulse.
+ */
+static void insertar_tiempo_real(BCP * proc){
+	BCP *ant = NULL, *paux = lista_listos.primero;
+
+	if (paux != NULL && paux == p_proc_actual){
+		ant = paux;
+		paux = paux->siguiente;
+	}
+	for ( ; paux && paux->tiempo_real && paux->plazo <= proc->plazo;
+		paux = paux->siguiente)
+		ant = paux;
+	insertar_tras(&lista_listos, ant, proc);
+}
+
+/*
+ * Tiempo real - Inserta un proceso normal en segundo lugar pero sin
+ * adelantar a las tareas EDF listas ni a los procesos envejecidos
+ */
+static void insertar_tras_tiempo_real(BCP * proc){
+	BCP *ant = lista_listos.primero;
+
+	if (ant == NULL || ant->siguiente == NULL ||
+	    (!ant->siguiente->tiempo_real && !ant->siguiente->envejecido)){
+		insertar_segundo(&lista_listos, proc);
+		return;
+	}
+	while (ant->siguiente &&
+	       (ant->siguiente->tiempo_real || ant->siguiente->envejecido))
+		ant = ant->siguiente;
+	insertar_tras(&lista_listos, ant, proc);
+}
+
+/*
+ * Tiempo real - Pide la int. SW si la tarea que acaba de quedar lista
+ * debe expulsar al proceso en ejecucion
+ */
+static void comprobar_expulsion(BCP * proc){
+	if (p_proc_actual == NULL || p_proc_actual->estado != EJECUCION)
+		return;
+	if (p_proc_actual->tiempo_real && p_proc_actual->plazo <= proc->plazo)
+		return;
+	/* al reproducir, la int. SW sale de la traza */
+	if (modo_traza != TRAZA_REPRODUCIR)
+		activar_int_SW();
+}
+
+/*
+ * Tiempo real - Indica si la primera tarea EDF lista tiene prioridad
+ * sobre el proceso en ejecucion
+ */
+static int expulsion_pendiente(){
+	BCP *sig = p_proc_actual->siguiente;
+
+	if (lista_listos.primero != p_proc_actual || sig == NULL ||
+	    !sig->tiempo_real)
+		return 0;
+	return !p_proc_actual->tiempo_real || sig->plazo < p_proc_actual->plazo;
+}
+
+/*
+ * Envejecimiento - Cuenta la espera en listos del proceso que pasa a
+ * ejecucion
+ */
+static void contar_espera_listo(BCP * proc){
+	unsigned long espera = ticks_sistema - proc->listo_desde;
+
+	proc->veces_listo++;
+	proc->espera_total += espera;
+	if (espera > proc->espera_max)
+		proc->espera_max = espera;
+	proc->envejecido = 0;
+}
+
+/*
+ * Envejecimiento - Adelanta a los procesos normales que llevan en la
+ * cola de listos PARAM_ENVEJECIMIENTO ticks o mas. Quedan detras de las
+ * tareas EDF y de los envejecidos antes que ellos, asi que ejecutan al
+ * acabar la rodaja en curso sin que los desbloqueados les adelanten.
+ */
+static void envejecer_listos(){
+	unsigned long umbral = PARAMETRO(PARAM_ENVEJECIMIENTO);
+	BCP *proc, *sig;
+
+	if (umbral == 0)
+		return;
+	for (proc = lista_listos.primero; proc != NULL; proc = sig){
+		sig = proc->siguiente;
+		if (proc == p_proc_actual || proc->tiempo_real ||
+		    proc->envejecido || ticks_sistema - proc->listo_desde < umbral)
+			continue;
+		printk("-> PROC %d: ENVEJECIDO TRAS %lu TICKS EN LISTOS\n",
+			proc->id, ticks_sistema - proc->listo_desde);
+		eliminar_elem(&lista_listos, proc);
+		insertar_tras_tiempo_real(proc);
+		proc->envejecido = 1;
+		proc->envejecimientos++;
+	}
+}
+
+/*
+* Practica 1 - Desbloquear procesos
+*/
+static void desbloquear (BCP* proc, lista_BCPs* lista){
+	(proc->estado) = LISTO;
+	proc->listo_desde = ticks_sistema;
+	eliminar_elem(lista, proc);
+	if (proc->tiempo_real){
+		insertar_tiempo_real(proc);
+		comprobar_expulsion(proc);
+	} else if ((proc->rodaja) > 0){
+		insertar_tras_tiempo_real(proc);
+	} else {
+		(proc->rodaja) = PARAMETRO(PARAM_RODAJA);
+		insertar_ultimo(&lista_listos, proc);
+	}
+}
+
+/*
+ *
+ * Funciones relacionadas con la espera de eventos:
+ *	registrar_espera anular_esperas activar_evento senalar_fuente
+ *	eventos_disponibles (esperar_en_fuentes, mas abajo)
+ *
+ */
+
+/*
+ * Apunta al proceso en la fuente con un nodo nuevo de la cache.
+ * Devuelve -1 si no queda memoria para el nodo.
+ */
+static int registrar_espera(BCP *proc, fuente_eventos *fuente){
+	nodo_espera *nodo = reservar_objeto(&cache_nodos_espera);
+
+	if (nodo == NULL)
+		return -1;
+	nodo->proc = proc;
+	nodo->fuente = fuente;
+	nodo->anterior = NULL;
+	nodo->siguiente = fuente->primero;
+	if (fuente->primero != NULL)
+		fuente->primero->anterior = nodo;
+	fuente->primero = nodo;
+	proc->esperas[proc->num_esperas++] = nodo;
+	return 0;
+}
+
+/*
+ * Borra al proceso de todas las fuentes en que espera; el coste solo
+ * depende del numero de fuentes y no de los procesos que esperan en
+ * cada una
+ */
+static void anular_esperas(BCP *proc){
+	nodo_espera *nodo;
+	int i;
+
+	for (i=0; i<proc->num_esperas; i++){
+		nodo = proc->esperas[i];
+		if (nodo->anterior != NULL)
+			nodo->anterior->siguiente = nodo->siguiente;
+		else
+			nodo->fuente->primero = nodo->siguiente;
+		if (nodo->siguiente != NULL)
+			nodo->siguiente->anterior = nodo->anterior;
+		liberar_objeto(&cache_nodos_espera, nodo);
+	}
+	proc->num_esperas = 0;
+}
+
+/*
+ * Anota el evento y, si el proceso lo estaba esperando, lo saca de
+ * las demas fuentes y lo desbloquea
+ */
+static void activar_evento(BCP *proc, int evento){
+	int nivel = fijar_nivel_int(NIVEL_3);
+
+	proc->eventos_listos |= evento;
+	if (proc->esperando_eventos){
+		proc->esperando_eventos = 0;
+		proc->eventos_ticks = 0;
+		anular_esperas(proc);
+		desbloquear(proc, &lista_eventos);
+	}
+	fijar_nivel_int(nivel);
+}
+
+/*
+ * Despierta a todos los procesos que esperan en la fuente
+ */
+static void senalar_fuente(fuente_eventos *fuente){
+	int nivel = fijar_nivel_int(NIVEL_3);
+
+	/* activar_evento borra el nodo de la fuente */
+	while (fuente->primero != NULL)
+		activar_evento(fuente->primero->proc, fuente->evento);
+	fijar_nivel_int(nivel);
+}
+
+/*
+ * Eventos del conjunto que ya estan disponibles para el proceso
+ */
+static int eventos_disponibles(BCP *proc, int conjunto){
+	int listos = 0;
+
+	if ((conjunto & EVENTO_TECLADO) && num_teclado > 0)
+		listos |= EVENTO_TECLADO;
+	if ((conjunto & EVENTO_HIJO) && proc->hijos_terminados > 0)
+		listos |= EVENTO_HIJO;
+	return listos;
+}
+
+/**
+ * Practica 3 - Tratar el padre
+ */
+static void tratar_padre(BCP *proc){
+	if (proc->ppid < 0) // init no tiene padre
+		return;
+	tabla_procs[proc->ppid].num_hijos--;
+	tabla_procs[proc->ppid].hijos_terminados++;
+	senalar_fuente(&tabla_procs[proc->ppid].fuente_hijos);
+	
+	if (proc->id != 0 &&
+	  (tabla_procs[proc->ppid].num_hijos <= 0) && 
+	  (tabla_procs[proc->ppid].estado == ESPERANDO)){
+		desbloquear(&tabla_procs[proc->ppid], &lista_espera);
+	}
+}
+
+/*
+ * Alarmas - Contexto en el que continua el proceso: el del manejador
+ * mientras atiende una alarma y el suyo propio en otro caso
+ */
+static contexto_t * contexto_de(BCP *proc){
+	if (proc->en_alarma)
+		return &(proc->contexto_alarma);
+	return &(proc->contexto_regs);
+}
+
+/*
+ * Alarmas - Si el proceso tiene una alarma vencida y no esta ya en el
+ * manejador, prepara un contexto nuevo que arranca el manejador en la
+ * pila de alarmas. Al volver el manejador, start llama a
+ * terminar_proceso, que en este caso solo da fin a la alarma.
+ */
+static void preparar_alarma(BCP *proc){
+	if (!proc->alarma_pendiente || proc->en_alarma)
+		return;
+	proc->alarma_pendiente = 0;
+	proc->en_alarma = 1;
+	fijar_contexto_ini(proc->info_mem, proc->pila_alarma, TAM_PILA_ALARMA,
+		proc->manejador, &(proc->contexto_alarma));
+}
+
+/*
+ * Causa de un cambio de contexto segun la lista a la que va el proceso
+ */
+static int causa_cambio(lista_BCPs* lista){
+	if (lista == &lista_dormidos)
+		return CAUSA_DORMIR;
+	if (lista == &lista_espera)
+		return CAUSA_ESPERA;
+	if (lista == &lista_listos)
+		return cesion_pendiente ? CAUSA_CEDER : CAUSA_EXPULSION;
+	if (lista == NULL)
+		return CAUSA_FIN;
+	return CAUSA_BLOQUEO;
+}
+
+/*
+ * Practica 2 - Cambios de contexto voluntarios e involuntarios
+ * Antes se llamaba bloquear -> para dormir procesos
+ * Ahora debe hacer ms cosas
+ */
+static void cambio_proceso (lista_BCPs* lista){
+	int nivel = fijar_nivel_int(NIVEL_3);
+	
+	BCP* proc = p_proc_actual;
+	contexto_t *salvar = contexto_de(proc);
+	
+	/* eventos pendientes antes de que el proceso deje el procesador */
+	if (modo_traza == TRAZA_REPRODUCIR)
+		reproducir_eventos();
+	
+	eliminar_primero(&lista_listos);
+	proc->lista_bloqueo = lista;
+		
+	if(lista == &lista_dormidos){ // Dormir
+		(proc->estado)=BLOQUEADO;
+		insertar_ultimo(lista,proc);
+	}
+	else if(lista == &lista_espera){ // Espera
+		(proc->estado)=ESPERANDO;
+		insertar_ultimo(lista,proc);
+	}
+	else if(lista == &lista_listos){ // Cambio
+		(proc->estado)=LISTO;
+		proc->listo_desde = ticks_sistema;
+		if (proc->tiempo_real)
+			insertar_tiempo_real(proc);
+		else if (expulsion_tiempo_real) // no pierde su turno
+			insertar_tras_tiempo_real(proc);
+		else
+			insertar_ultimo(lista,proc);
+		expulsion_tiempo_real = 0;
+	}
+	else if(lista == NULL){ // Liberar: imagen y pila se liberan en recoger_zombis
+		(proc->estado)=ZOMBI;
+		adoptar_huerfanos(proc);
+		tratar_padre(proc);
+		insertar_ultimo(&lista_zombis,proc);
+	}
+	else { // Bloqueo en otra lista (tuberias, ...)
+		(proc->estado)=BLOQUEADO;
+		insertar_ultimo(lista,proc);
+	}
+	
+	p_proc_actual = planificador();
+	contar_espera_listo(p_proc_actual);
+	(p_proc_actual->estado) = EJECUCION;
+	(p_proc_actual->activaciones)++;
+	if (p_proc_actual != proc)
+		est_sistema.cambios[causa_cambio(lista)]++;
+	cesion_pendiente = 0;
+	
+	printk("-> C.CONTEXTO POR FIN: de %d a %d\n",
+		proc->id, p_proc_actual->id);
+	
+	/* las alarmas se entregan al pasar a ejecucion */
+	preparar_alarma(p_proc_actual);
+	
+	fijar_nivel_int(nivel);
+	
+	if (lista != NULL){
+		cambio_contexto(salvar, contexto_de(p_proc_actual));
+	} else {
+		cambio_contexto(NULL, contexto_de(p_proc_actual));
+	}
+}
+
+/*
+ * Espera de eventos - Bloquea al proceso actual en las fuentes del
+ * conjunto durante como mucho timeout ticks (negativo: sin plazo).
+ * Hay que llamarla a NIVEL_3 tras comprobar que no hay nada
+ * disponible. Devuelve los eventos que lo despertaron o -1 si no hay
+ * memoria para los nodos.
+ */
+static int esperar_en_fuentes(int conjunto, int timeout){
+	BCP *proc = p_proc_actual;
+	int listos;
+
+	if (((conjunto & EVENTO_TECLADO) &&
+	      registrar_espera(proc, &fuente_teclado) < 0) ||
+	    ((conjunto & EVENTO_HIJO) &&
+	      registrar_espera(proc, &(proc->fuente_hijos)) < 0)){
+		anular_esperas(proc);
+		return -1;
+	}
+	proc->eventos_listos = 0;
+	proc->eventos_ticks = (timeout > 0) ? timeout : 0;
+	proc->esperando_eventos = 1;
+	cambio_proceso(&lista_eventos);
+
+	listos = proc->eventos_listos;
+	proc->eventos_listos = 0;
+	return listos;
+}
+
+/*
+ *
+ * Funciones relacionadas con las tuberias:
+ *	despertar_todos abrir_extremo cerrar_extremo
+ *	tuberia_desc buscar_desc_libre cerrar_descriptores
+ *
+ */
+
+/*
+ * Desbloquea todos los procesos de una lista de espera
+ */
+static void despertar_todos(lista_BCPs *lista){
+	int nivel = fijar_nivel_int(NIVEL_3);
+
+	while (lista->primero != NULL)
+		desbloquear(lista->primero, lista);
+	fijar_nivel_int(nivel);
+}
+
+/*
+ * Anota un nuevo descriptor abierto sobre un extremo de la tuberia
+ */
+static void abrir_extremo(tuberia *tub, int extremo){
+	if (extremo == LECTURA)
+		tub->lectores++;
+	else
+		tub->escritores++;
+}
+
+/*
+ * Cierra un extremo de la tuberia. Al irse el ultimo escritor los
+ * lectores bloqueados ven fin de fichero; al irse el ultimo lector
+ * los escritores bloqueados ven el error.
+ */
+static void cerrar_extremo(tuberia *tub, int extremo){
+	if (extremo == LECTURA){
+		if (--(tub->lectores) == 0)
+			despertar_todos(&tub->lista_escritores);
+	} else {
+		if (--(tub->escritores) == 0)
+			despertar_todos(&tub->lista_lectores);
+	}
+	if (tub->lectores == 0 && tub->escritores == 0)
+		liberar_objeto(&cache_tuberias, tub);
+}
+
+/*
+ * Devuelve la tuberia asociada al descriptor del proceso actual si
+ * es valido y corresponde al extremo pedido; NULL en otro caso
+ */
+static tuberia * tuberia_desc(int desc, int extremo){
+	descriptor *d;
+
+	if (desc < 0 || desc >= MAX_DESC)
+		return NULL;
+	d = &(p_proc_actual->descriptores[desc]);
+	if (d->tuberia == NULL || d->extremo != extremo)
+		return NULL;
+	return d->tuberia;
+}
+
+/*
+ * Busca un descriptor libre en el proceso a partir de una posicion
+ */
+static int buscar_desc_libre(BCP *proc, int desde){
+	int i;
+
+	for (i=desde; i<MAX_DESC; i++)
+		if (proc->descriptores[i].tuberia == NULL)
+			return i;
+	return -1;
+}
+
+/*
+ * Cierra todos los descriptores que quedan abiertos en el proceso
+ */
+static void cerrar_descriptores(BCP *proc){
+	int i;
+
+	for (i=0; i<MAX_DESC; i++)
+		if (proc->descriptores[i].tuberia != NULL){
+			cerrar_extremo(proc->descriptores[i].tuberia,
+				proc->descriptores[i].extremo);
+			proc->descriptores[i].tuberia = NULL;
+		}
+}
+
+/*
+ *
+ * Funciones de los semaforos y barreras:
+ *	buscar_semaforo semaforo_abierto cerrar_semaforo cerrar_semaforos
+ *	liberar_barrera
+ *
+ */
+
+/*
+ * Devuelve el semaforo con ese nombre, o el primero libre si libre es
+ * 1 y no existe. NULL si no lo encuentra o el nombre es muy largo.
+ */
+static semaforo * buscar_semaforo(char *nombre, int libre){
+	semaforo *sem, *hueco = NULL;
+	int i, j;
+
+	for (j=0; nombre[j] != '\0'; j++)
+		if (j == MAX_NOMBRE_SEM - 1)
+			return NULL;
+	if (j == 0)
+		return NULL;
+	for (i=0; i<NUM_SEMAFOROS; i++){
+		sem = &tabla_semaforos[i];
+		if (sem->nombre[0] == '\0'){
+			if (hueco == NULL)
+				hueco = sem;
+			continue;
+		}
+		for (j=0; nombre[j] == sem->nombre[j] && nombre[j] != '\0'; j++);
+		if (nombre[j] == sem->nombre[j])
+			return sem;
+	}
+	return libre ? hueco : NULL;
+}
+
+/*
+ * Devuelve el semaforo id si el proceso actual lo tiene abierto
+ */
+static semaforo * semaforo_abierto(int id){
+	if (id < 0 || id >= NUM_SEMAFOROS || !p_proc_actual->semaforos[id])
+		return NULL;
+	return &tabla_semaforos[id];
+}
+
+/*
+ * Quita al proceso el semaforo id y libera la entrada si era el ultimo
+ */
+static void cerrar_semaforo(BCP *proc, int id){
+	proc->semaforos[id] = 0;
+	if (--(tabla_semaforos[id].abiertos) == 0)
+		tabla_semaforos[id].nombre[0] = '\0';
+}
+
+/*
+ * Cierra todos los semaforos que tenga abiertos el proceso
+ */
+static void cerrar_semaforos(BCP *proc){
+	int i;
+
+	for (i=0; i<NUM_SEMAFOROS; i++)
+		if (proc->semaforos[i])
+			cerrar_semaforo(proc, i);
+}
+
+/*
+ * Pasa a listos de una vez a todos los que esperan en la barrera con el
+ * mismo criterio que desbloquear, pero conservando el orden de llegada:
+ * se recorren una vez y se forman dos cadenas. Los que conservan rodaja
+ * se enganchan detras de las tareas EDF y los envejecidos; los que la
+ * habian agotado la recuperan y van al final de la cola.
+ */
+static void liberar_barrera(semaforo *sem){
+	BCP *proc, *sig, *ant;
+	lista_BCPs cadena = {NULL, NULL}, agotados = {NULL, NULL};
+	int nivel = fijar_nivel_int(NIVEL_3);
+
+	for (proc = sem->bloqueados.primero; proc != NULL; proc = sig){
+		sig = proc->siguiente;
+		proc->estado = LISTO;
+		proc->listo_desde = ticks_sistema;
+		if (proc->tiempo_real){
+			insertar_tiempo_real(proc);
+			comprobar_expulsion(proc);
+		} else if (proc->rodaja > 0)
+			insertar_ultimo(&cadena, proc);
+		else {
+			proc->rodaja = PARAMETRO(PARAM_RODAJA);
+			insertar_ultimo(&agotados, proc);
+		}
+	}
+	sem->bloqueados.primero = sem->bloqueados.ultimo = NULL;
+	if (cadena.primero != NULL){
+		ant = lista_listos.primero;
+		while (ant != NULL && ant->siguiente != NULL &&
+		       (ant->siguiente->tiempo_real || ant->siguiente->envejecido))
+			ant = ant->siguiente;
+		if (ant == NULL){
+			lista_listos = cadena;
+		} else {
+			cadena.ultimo->siguiente = ant->siguiente;
+			ant->siguiente = cadena.primero;
+			if (cadena.ultimo->siguiente == NULL)
+				lista_listos.ultimo = cadena.ultimo;
+		}
+	}
+	if (agotados.primero != NULL){
+		if (lista_listos.primero == NULL)
+			lista_listos.primero = agotados.primero;
+		else
+			lista_listos.ultimo->siguiente = agotados.primero;
+		lista_listos.ultimo = agotados.ultimo;
+	}
+	fijar_nivel_int(nivel);
+}
+
+/*
+ *
+ * Funciones de los grupos de procesos:
+ *	entrar_grupo salir_grupo
+ *
+ */
+
+/*
+ * Anade el proceso al principio del grupo gid
+ */
+static void entrar_grupo(BCP *proc, int gid){
+	grupo *g = &tabla_grupos[gid];
+
+	if (g->miembros++ == 0){
+		g->esperando.primero = g->esperando.ultimo = NULL;
+		g->peso = PESO_DEFECTO;
+		g->cuota = 0;
+		g->uso = g->total = 0;
+		g->estrangulado = 0;
+		g->estrangulamientos = 0;
+	}
+	proc->gid = gid;
+	proc->ant_grupo = NULL;
+	proc->sig_grupo = g->primero;
+	if (g->primero != NULL)
+		g->primero->ant_grupo = proc;
+	g->primero = proc;
+}
+
+/*
+ * Quita el proceso de su grupo; si era el ultimo despierta a los que
+ * esperan a que se vacie y la entrada queda libre
+ */
+static void salir_grupo(BCP *proc){
+	grupo *g = &tabla_grupos[proc->gid];
+
+	if (proc->ant_grupo != NULL)
+		proc->ant_grupo->sig_grupo = proc->sig_grupo;
+	else
+		g->primero = proc->sig_grupo;
+	if (proc->sig_grupo != NULL)
+		proc->sig_grupo->ant_grupo = proc->ant_grupo;
+	if (--(g->miembros) == 0){
+		g->generacion++;
+		despertar_todos(&g->esperando);
+	}
+}
+
+/*
+ *
+ * Funciones auxiliares que terminan procesos liberando sus recursos:
+ *	liberar_recursos liberar_proceso matar_proceso
+ *
+ */
+
+/*
+ * Libera lo que el proceso tiene abierto, salvo la pila y la imagen,
+ * que espera a recoger_zombis
+ */
+static void liberar_recursos(BCP *proc){
+	cerrar_descriptores(proc);
+	cerrar_semaforos(proc);
+	liberar_perfil(proc);
+	liberar_anillo(proc);
+	salir_grupo(proc);
+	if (proc->veces_listo > 0)
+		printk("-> PROC %d: ESPERA EN LISTOS media %lu max %lu\n",
+			proc->id, proc->espera_total / proc->veces_listo,
+			proc->espera_max);
+	if (proc->tiempo_real){
+		printk("-> PROC %d: PLAZOS PERDIDOS %d\n", proc->id,
+			proc->plazos_perdidos);
+		utilizacion_tiempo_real -= utilizacion(proc->periodo,
+			proc->presupuesto);
+	}
+}
+
+/*
+ *
+ * Funcion auxiliar que termina proceso actual liberando sus recursos.
+ * Usada por llamada terminar_proceso y por rutinas que tratan excepciones
+ *
+ */
+static void liberar_proceso(){
+	liberar_recursos(p_proc_actual);
+	cambio_proceso(NULL);
+}
+
+/*
+ * Termina un proceso que no esta en ejecucion: lo saca de la lista en
+ * que espera (si es una barrera, deja de contar como llegado) y lo
+ * deja zombi como si hubiera terminado. Su pila, con la llamada al
+ * sistema que tuviera a medias, se libera en recoger_zombis.
+ */
+static void matar_proceso(BCP *proc){
+	int i, nivel = fijar_nivel_int(NIVEL_3);
+
+	if (proc->estado == LISTO)
+		eliminar_elem(&lista_listos, proc);
+	else {
+		if (proc->esperando_eventos){
+			proc->esperando_eventos = 0;
+			anular_esperas(proc);
+		}
+		eliminar_elem(proc->lista_bloqueo, proc);
+		for (i=0; i<NUM_SEMAFOROS; i++)
+			if (proc->lista_bloqueo == &tabla_semaforos[i].bloqueados &&
+			    tabla_semaforos[i].partes > 0)
+				tabla_semaforos[i].llegados--;
+	}
+	fijar_nivel_int(nivel);
+	printk("-> PROC %d: MATADO POR %d\n", proc->id, p_proc_actual->id);
+	liberar_recursos(proc);
+	proc->estado = ZOMBI;
+	adoptar_huerfanos(proc);
+	tratar_padre(proc);
+	insertar_ultimo(&lista_zombis, proc);
+}
+
+/*
+* Practica 1 - Ajustar Dormidos
+* Un dormido puede despertar desde que vence su plazo hasta holgura
+* ticks despues. Solo se hace una pasada cuando alguno agota su
+* holgura, y en ella se despierta a todos los que ya han vencido.
+*/
+static void ajustar_dormidos (){
+	BCP* head = lista_dormidos.primero;
+	int pasada = 0;
+	while(head != NULL){
+		(head->ticks)--;
+		if ((head->ticks) + (head->holgura) <= 0)
+			pasada = 1;
+		head = head->siguiente;
+	}
+	if (!pasada)
+		return;
+	est_sistema.pasadas_despertar++;
+	head = lista_dormidos.primero;
+	while(head != NULL){
+		BCP* head2 = head->siguiente;
+		if ((head->ticks) <= 0){
+			est_sistema.despertados++;
+			desbloquear(head, &lista_dormidos);
+		}
+		head = head2;
+	}
+}
+
+/*
+ * Tiempo real - Trabajo de cada tick para las tareas EDF: cuenta el
+ * presupuesto de la que ejecuta, pasa al siguiente periodo las que han
+ * superado su plazo (plazo perdido) y activa las que esperan periodo.
+ */
+static void ajustar_tiempo_real(){
+	BCP *proc, *sig;
+
+	if (p_proc_actual != NULL && p_proc_actual->estado == EJECUCION &&
+	    p_proc_actual->tiempo_real &&
+	    ++(p_proc_actual->consumido) >= p_proc_actual->presupuesto &&
+	    modo_traza != TRAZA_REPRODUCIR)
+		activar_int_SW();	/* tratar_int_sw la retira */
+
+	/* al mover el plazo se recoloca; solo puede ir hacia atras */
+	for (proc = lista_listos.primero; proc != NULL; proc = sig){
+		sig = proc->siguiente;
+		if (!proc->tiempo_real || proc->plazo > ticks_sistema)
+			continue;
+		proc->plazos_perdidos++;
+		proc->plazo += proc->periodo;
+		proc->activacion = proc->plazo;
+		proc->consumido = 0;
+		if (proc != p_proc_actual){
+			eliminar_elem(&lista_listos, proc);
+			insertar_tiempo_real(proc);
+		} else if (expulsion_pendiente() && modo_traza != TRAZA_REPRODUCIR)
+			activar_int_SW();
+	}
+
+	for (proc = lista_tiempo_real.primero; proc != NULL; proc = sig){
+		sig = proc->siguiente;
+		if (proc->activacion > ticks_sistema)
+			continue;
+		/* se activa al vencer el plazo del trabajo que no acabo */
+		if (proc->sin_presupuesto){
+			proc->plazos_perdidos++;
+			proc->sin_presupuesto = 0;
+		}
+		proc->plazo = proc->activacion + proc->periodo;
+		proc->activacion = proc->plazo;
+		proc->consumido = 0;
+		desbloquear(proc, &lista_tiempo_real);
+	}
+}
+
+/*
+ * Alarmas - Descuenta un tick de las alarmas programadas. La vencida
+ * del proceso en ejecucion se entrega ya desde la int. SW; la de los
+ * demas, cuando vuelvan a ejecutar.
+ */
+static void ajustar_alarmas(){
+	BCP *proc;
+	int i;
+
+	for (i=0; i<MAX_PROC; i++){
+		proc = &tabla_procs[i];
+		if (proc->alarma_ticks == 0 || proc->estado == NO_USADA ||
+		    proc->estado == ZOMBI || --(proc->alarma_ticks) > 0)
+			continue;
+		proc->alarma_pendiente = 1;
+		proc->alarma_ticks = proc->alarma_periodo;
+		if (proc == p_proc_actual && proc->estado == EJECUCION &&
+		    modo_traza != TRAZA_REPRODUCIR)
+			activar_int_SW();
+	}
+}
+
+/*
+ * Alarmas - Fin del manejador: vuelve al contexto que interrumpio. Si
+ * vencio otra alarma entretanto, la int. SW la entregara.
+ */
+static void fin_alarma(){
+	p_proc_actual->en_alarma = 0;
+	if (p_proc_actual->alarma_pendiente && modo_traza != TRAZA_REPRODUCIR)
+		activar_int_SW();
+	cambio_contexto(NULL, &(p_proc_actual->contexto_regs));
+}
+
+/*
+ * Espera de eventos - Descuenta un tick de los plazos de los procesos
+ * bloqueados en esperar_eventos
+ */
+static void ajustar_eventos(){
+	BCP *proc, *sig;
+
+	for (proc = lista_eventos.primero; proc != NULL; proc = sig){
+		sig = proc->siguiente;
+		if (proc->eventos_ticks > 0 && --(proc->eventos_ticks) == 0)
+			activar_evento(proc, EVENTO_TIEMPO);
+	}
+}
+
+/*
+ * Reparto - Carga el tick al grupo del proceso en ejecucion y lo
+ * estrangula si agota su cuota; al empezar cada periodo se ponen a cero
+ * las cuentas y se libera a los estrangulados
+ */
+static void ajustar_reparto(){
+	grupo *g;
+	int i;
+
+	if (p_proc_actual != NULL && p_proc_actual->estado == EJECUCION){
+		g = &tabla_grupos[p_proc_actual->gid];
+		g->uso++;
+		g->total++;
+		if (g->cuota > 0 && g->uso >= g->cuota && !g->estrangulado){
+			g->estrangulado = 1;
+			g->estrangulamientos++;
+			if (estrangulado(p_proc_actual) &&
+			    modo_traza != TRAZA_REPRODUCIR)
+				activar_int_SW();
+		}
+	}
+	if (ticks_sistema % PARAMETRO(PARAM_PERIODO_REPARTO) == 0)
+		for (i=0; i<MAX_PROC; i++){
+			tabla_grupos[i].uso = 0;
+			tabla_grupos[i].estrangulado = 0;
+		}
+}
+
+/*
+ * Practica 2 - Actualiza la rodaja de tiempo y al final de esta, ejecuta una interrupcin de software
+ */
+static void actualizar_rodaja(){
+	if (p_proc_actual != NULL && (p_proc_actual->estado) == EJECUCION &&
+	    !p_proc_actual->tiempo_real){
+		(p_proc_actual->rodaja)--;
+		if ((p_proc_actual->rodaja)<=0){
+			replanificacion_pendiente = 1;
+			/* al reproducir, la int. SW tambien sale de la traza */
+			if (modo_traza != TRAZA_REPRODUCIR)
+				activar_int_SW();
+		}
+	}
+}
+
+/*
+ * Actualiza la carga media con la longitud actual de la cola de listos
+ * (incluye al proceso en ejecucion), igual que la de UNIX pero con
+ * periodos de 1, 5 y 15 segundos
+ */
+static void actualizar_carga(){
+	static unsigned long factores[3] = {EXP_CARGA_1, EXP_CARGA_5, EXP_CARGA_15};
+	unsigned long n = 0;
+	BCP *proc;
+	int i;
+
+	for (proc = lista_listos.primero; proc != NULL; proc = proc->siguiente)
+		n++;
+	est_sistema.listos = n;
+	for (i=0; i<3; i++)
+		est_sistema.carga[i] = (est_sistema.carga[i] * factores[i] +
+			n * UNO_CARGA * (UNO_CARGA - factores[i])) >> SHIFT_CARGA;
+}
+
+/*
+ *
+ * Funciones relacionadas con el tratamiento de interrupciones
+ *	excepciones: exc_arit exc_mem
+ *	interrupciones de reloj: int_reloj
+ *	interrupciones del terminal: int_terminal
+ *	llamadas al sistemas: llam_sis
+ *	interrupciones SW: int_sw
+ *
+ */
+
+/*
+ * Tratamiento de excepciones aritmeticas
+ */
+static void exc_arit(){
+	est_sistema.interrupciones[EXC_ARITM]++;
+
+	if (!viene_de_modo_usuario())
+		panico("excepcion aritmetica cuando estaba dentro del kernel");
+
+
+	printk("-> EXCEPCION ARITMETICA EN PROC %d\n", p_proc_actual->id);
+	liberar_proceso();
+
+        return; /* no debera llegar aqui */
+}
+
+/*
+ * Tratamiento de excepciones en el acceso a memoria
+ */
+static void exc_mem(){
+	est_sistema.interrupciones[EXC_MEM]++;
+
+	if (!viene_de_modo_usuario())
+		panico("excepcion de memoria cuando estaba dentro del kernel");
+
+
+	printk("-> EXCEPCION DE MEMORIA EN PROC %d\n", p_proc_actual->id);
+	liberar_proceso();
+
+        return; /* no debera llegar aqui */
+}
+
+/*
+ * Tratamiento de un caracter recibido por el terminal
+ */
+static void tratar_terminal(char car){
+
+	printk("-> TRATANDO INT. DE TERMINAL %c\n", car);
+
+	/* se guarda para leer_caracter; si no cabe se pierde */
+	if (num_teclado < TAM_BUF_TECLADO){
+		buffer_teclado[(ini_teclado + num_teclado) % TAM_BUF_TECLADO] = car;
+		num_teclado++;
+	}
+	senalar_fuente(&fuente_teclado);
+
+        return;
+}
+
+/*
+ * Tratamiento de interrupciones de terminal
+ */
+static void int_terminal(){
+	char car = leer_puerto(DIR_TERMINAL);
+
+	est_sistema.interrupciones[INT_TERMINAL]++;
+	if (modo_traza == TRAZA_REPRODUCIR)
+		return;		/* la entrada sale de la traza */
+	if (modo_traza == TRAZA_GRABAR)
+		registrar_evento(EV_TERMINAL, car);
+	tratar_terminal(car);
+}
+
+/*
+ * Trabajo asociado a cada tick de reloj
+ */
+static void tratar_reloj(){
+	ticks_sistema++;
+	if (ticks_sistema % (PARAMETRO(PARAM_TICK) / MUESTRAS_CARGA_POR_SEG) == 0)
+		actualizar_carga();
+	actualizar_rodaja();
+	ajustar_dormidos();
+	ajustar_tiempo_real();
+	ajustar_alarmas();
+	ajustar_eventos();
+	envejecer_listos();
+	ajustar_reparto();
+}
+
+/*
+ * Tratamiento de interrupciones de reloj
+ */
+static void int_reloj(){  
+	printk("-> TRATANDO INT. DE reloj \n");
+	est_sistema.interrupciones[INT_RELOJ]++;
+	/* el marco guardado en el nuestro es el del manejador de la senal */
+	muestrear_perfil(*(void **)__builtin_frame_address(0));
+	if (modo_traza == TRAZA_REPRODUCIR)
+		return;		/* los ticks salen de la traza */
+	if (modo_traza == TRAZA_GRABAR)
+		registrar_evento(EV_RELOJ, 0);
+	tratar_reloj();
+}
+
+/*
+ * Ejecuta el servicio con los argumentos que hay en los registros 1 a
+ * 5 con toda la contabilidad de una llamada: traza de grabacion o
+ * reproduccion, cuentas del proceso y del sistema y anillo del proceso
+ * si se le traza. La usan tratar_llamsis y procesar_lote, asi que cada
+ * peticion de un lote cuenta como una llamada.
+ */
+static int ejecutar_servicio(int nserv){
+	int res, nivel, trazada;
+	info_llamada llamada;
+
+	/* ninguna interrupcion debe verse entre la traza y la cuenta */
+	nivel=fijar_nivel_int(NIVEL_3);
+	if (modo_traza != TRAZA_NINGUNA)
+		traza_llamada(nserv);
+	p_proc_actual->num_llamadas++;
+	trazada = p_proc_actual->llamadas != NULL &&
+		inicio_llamada(&llamada, nserv);
+	fijar_nivel_int(nivel);
+	if (nserv>=0 && nserv<NSERVICIOS){
+		est_sistema.llamadas[nserv]++;
+		res=(tabla_servicios[nserv].fservicio)();
+	}
+	else
+		res=-1;		/* servicio no existente */
+	if (trazada)
+		fin_llamada(&llamada, res);
+	return res;
+}
+
+/*
+ * Tratamiento de llamadas al sistema
+ */
+static void tratar_llamsis(){
+	int nserv, res;
+
+	nserv=leer_registro(0);
+	est_sistema.interrupciones[LLAM_SIS]++;
+	res=ejecutar_servicio(nserv);
+	escribir_registro(0,res);
+	return;
+}
+
+/*
+ * Tratamiento de interrupciuones software
+ */
+static void tratar_int_sw(){
+	if (estrangulado(p_proc_actual)){
+		/* su grupo ha agotado la cuota: espera al siguiente periodo */
+		cambio_proceso(&lista_listos);
+		return;
+	}
+	if (p_proc_actual->tiempo_real &&
+	    p_proc_actual->consumido >= p_proc_actual->presupuesto){
+		/* presupuesto agotado: el plazo se contara perdido al
+		   vencer, cuando empiece el siguiente periodo */
+		p_proc_actual->sin_presupuesto = 1;
+		cambio_proceso(&lista_tiempo_real);
+		return;
+	}
+	if (expulsion_pendiente()){
+		expulsion_tiempo_real = 1;
+		cambio_proceso(&lista_listos);
+		return;
+	}
+	if (p_proc_actual->alarma_pendiente && !p_proc_actual->en_alarma){
+		preparar_alarma(p_proc_actual);
+		cambio_contexto(&(p_proc_actual->contexto_regs),
+			&(p_proc_actual->contexto_alarma));
+		return;
+	}
+	/* la int. SW puede venir de otra causa ya atendida: solo se rota
+	   si de verdad se ha agotado la rodaja */
+	if (replanificacion_pendiente == 1 && !p_proc_actual->tiempo_real &&
+	    p_proc_actual->rodaja <= 0){
+		replanificacion_pendiente = 0;
+		if((p_proc_actual->siguiente) == NULL){
+			(p_proc_actual->rodaja) = PARAMETRO(PARAM_RODAJA);
+		} else {
+			(p_proc_actual->vueltas)++;
+			if ((p_proc_actual->vueltas) >= PARAMETRO(PARAM_VUELTAS_MAX)){
+				(p_proc_actual->vueltas) = VUELTAS_INIT;
+				(p_proc_actual->ticks) = PARAMETRO(PARAM_CASTIGO);
+				cambio_proceso(&lista_dormidos);
+			} else {
+				/* media rodaja, pero nunca vacia */
+				(p_proc_actual->rodaja) = PARAMETRO(PARAM_RODAJA) / 2;
+				if ((p_proc_actual->rodaja) < 1)
+					(p_proc_actual->rodaja) = 1;
+				cambio_proceso(&lista_listos);
+			}
+		}
+	}
+	return;
+}
+
+static void int_sw(){
+	printk("-> TRATANDO INT. SW\n");
+	est_sistema.interrupciones[INT_SW]++;
+	if (modo_traza == TRAZA_REPRODUCIR)
+		return;		/* se activa al reproducir el evento */
+	if (modo_traza == TRAZA_GRABAR)
+		registrar_evento(EV_SW, 0);
+	tratar_int_sw();
 }
 
 /*
- * Funcion auxiliar que crea un proceso reservando sus recursos.
- * Usada por llamada crear_proceso.
  *
+ * Funciones relacionadas con la traza de interrupciones:
+ *	registrar_evento evento_en_curso reproducir_eventos
+ *	traza_llamada divergencia
+ *
+ * Al grabar, cada interrupcion y llamada se vuelca como una linea
+ * "#TRAZA" (ver traza.sh). Al reproducir se ignoran el reloj, el
+ * terminal y la int. SW reales y cada evento se aplica cuando el
+ * proceso al que esta anclado llega a una llamada al sistema o deja
+ * el procesador, con lo que el orden de los eventos del kernel es el
+ * mismo que en la ejecucion grabada.
+ */
+
+/*
+ * Vuelca un evento anclado al estado actual
+ */
+static void registrar_evento(int tipo, int dato){
+	if (procesador_parado)
+		printk("#TRAZA %lu -1 0 0 %d %d\n", ticks_sistema, tipo, dato);
+	else
+		printk("#TRAZA %lu %d %d %d %d %d\n", ticks_sistema,
+			p_proc_actual->id, p_proc_actual->num_llamadas,
+			p_proc_actual->activaciones, tipo, dato);
+}
+
+/*
+ * Indica si el evento de la traza esta anclado al estado actual
+ */
+static int evento_en_curso(evento_traza *ev){
+	if (procesador_parado)
+		return ev->pid == -1;
+	return ev->pid == p_proc_actual->id &&
+		ev->llamadas == p_proc_actual->num_llamadas &&
+		ev->activaciones == p_proc_actual->activaciones;
+}
+
+/*
+ * Deja de reproducir y sigue con las interrupciones reales
+ */
+static void divergencia(){
+	printk("-> TRAZA: la ejecucion se separa de la traza en el evento %d\n",
+		evento_actual);
+	modo_traza = TRAZA_NINGUNA;
+}
+
+/*
+ * Aplica los eventos de la traza anclados al estado actual. Devuelve
+ * cuantos ha aplicado.
+ */
+static int reproducir_eventos(){
+	evento_traza *ev;
+	int aplicados = 0;
+
+	while (modo_traza == TRAZA_REPRODUCIR){
+		ev = &traza_reproduccion[evento_actual];
+		if (ev->tipo == EV_FIN){
+			printk("-> TRAZA: reproducidos %d eventos\n", evento_actual);
+			modo_traza = TRAZA_NINGUNA;
+			break;
+		}
+		if (ev->tipo == EV_LLAMADA || !evento_en_curso(ev))
+			break;
+		evento_actual++;
+		aplicados++;
+		if (ev->tipo == EV_RELOJ)
+			tratar_reloj();
+		else if (ev->tipo == EV_TERMINAL)
+			tratar_terminal(ev->dato);
+		else
+			tratar_int_sw();	/* puede ceder el procesador */
+	}
+	return aplicados;
+}
+
+/*
+ * Graba la llamada al sistema o, al reproducir, comprueba que es la
+ * que sigue en la traza tras aplicar los eventos previos
+ */
+static void traza_llamada(int nserv){
+	evento_traza *ev;
+
+	if (modo_traza == TRAZA_GRABAR){
+		registrar_evento(EV_LLAMADA, nserv);
+		return;
+	}
+	reproducir_eventos();
+	if (modo_traza != TRAZA_REPRODUCIR)
+		return;
+	ev = &traza_reproduccion[evento_actual];
+	if (ev->tipo == EV_LLAMADA && evento_en_curso(ev) && ev->dato == nserv)
+		evento_actual++;
+	else
+		divergencia();
+}
+
+/*
+ * Argumentos - Bytes que ocupan los argumentos en la pila (vector de
+ * punteros terminado en NULL y cadenas, alineado a 16) o -1 si superan
+ * los limites
+ */
+static int tam_argumentos(int argc, char **argv){
+	int i, j, tam;
+
+	if (argc < 0 || argc > MAX_ARGS || (argc > 0 && argv == NULL))
+		return -1;
+	tam = (argc + 1) * sizeof(char *);
+	for (i=0; i<argc; i++){
+		if (argv[i] == NULL)
+			return -1;
+		for (j=0; argv[i][j] != '\0'; j++);
+		tam += j + 1;
+	}
+	tam = (tam + 15) & ~15;
+	return (tam > TAM_MAX_ARGS) ? -1 : tam;
+}
+
+/*
+ * Argumentos - Copia los argumentos en lo alto de la pila del proceso,
+ * donde no llega la pila que prepara fijar_contexto_ini
+ */
+static void copiar_argumentos(BCP *p_proc, int argc, char **argv, int tam){
+	char *dest;
+	int i, j;
+
+	p_proc->argc = argc;
+	p_proc->argv = (char **)((char *)p_proc->pila + p_proc->tam_pila - tam);
+	dest = (char *)(p_proc->argv + argc + 1);
+	for (i=0; i<argc; i++){
+		p_proc->argv[i] = dest;
+		for (j=0; (dest[j] = argv[i][j]) != '\0'; j++);
+		dest += j + 1;
+	}
+	p_proc->argv[argc] = NULL;
+}
+
+/*
+ * Funcion auxiliar que crea un proceso reservando sus recursos, con
+ * una pila de tam_pila bytes. Si recibe argv (aunque sea vacio) arranca
+ * en la funcion arranque_args de la biblioteca, que los pide con la
+ * llamada argumentos y se los pasa a main.
+ * Usada por llamada crear_proceso.
+ *
+ */
+static int crear_tarea(char *prog, int tam_pila, int argc, char **argv){
+	void * imagen, *pc_inicial;
+	int error=0;
+	int proc, i, tam_args=0;
+	BCP *p_proc;
+
+	proc=buscar_BCP_libre();
+	if (proc==-1)
+		return -1;	/* no hay entrada libre */
+
+	/* A rellenar el BCP ... */
+	p_proc=&(tabla_procs[proc]);
+
+	/* las imagenes de los terminados se sueltan antes de cargar otra:
+	   si no, una nueva ejecucion del programa heredaria sus datos */
+	if (lista_zombis.primero != NULL)
+		recoger_zombis(MAX_PROC);
+
+	/* crea la imagen de memoria leyendo ejecutable */
+	imagen=crear_imagen(prog, &pc_inicial);
+	if (imagen && argv != NULL){
+		tam_args = tam_argumentos(argc, argv);
+		pc_inicial = dlsym(imagen, "arranque_args");
+		if (pc_inicial == NULL){	/* no enlaza la biblioteca */
+			liberar_imagen(imagen);
+			imagen = NULL;
+		}
+	}
+	if (imagen)
+	{
+		p_proc->info_mem=imagen;
+		p_proc->pila=tomar_pila(tam_pila);
+		p_proc->tam_pila=tam_pila;
+		p_proc->memoria=tam_pila;
+		memoria_pilas += tam_pila;
+		p_proc->argc=0;
+		p_proc->argv=NULL;
+		if (argv != NULL)
+			copiar_argumentos(p_proc, argc, argv, tam_args);
+		fijar_contexto_ini(p_proc->info_mem, p_proc->pila,
+			tam_pila - tam_args,
+			pc_inicial,
+			&(p_proc->contexto_regs));
+		p_proc->id=proc;
+		p_proc->estado=LISTO;
+		p_proc->rodaja=PARAMETRO(PARAM_RODAJA);
+		p_proc->vueltas=VUELTAS_INIT;
+		p_proc->num_hijos=0;
+		p_proc->num_llamadas=0;
+		p_proc->activaciones=0;
+		p_proc->tiempo_real=0;
+		p_proc->plazos_perdidos=0;
+		p_proc->sin_presupuesto=0;
+		p_proc->alarma_ticks=0;
+		p_proc->alarma_pendiente=0;
+		p_proc->en_alarma=0;
+		p_proc->pila_alarma=NULL;
+		p_proc->esperando_eventos=0;
+		p_proc->eventos_ticks=0;
+		p_proc->num_esperas=0;
+		p_proc->hijos_terminados=0;
+		p_proc->fuente_hijos.primero=NULL;
+		p_proc->fuente_hijos.evento=EVENTO_HIJO;
+		p_proc->listo_desde=ticks_sistema;
+		p_proc->veces_listo=0;
+		p_proc->espera_total=0;
+		p_proc->espera_max=0;
+		p_proc->envejecido=0;
+		p_proc->envejecimientos=0;
+		p_proc->perfil=NULL;
+		p_proc->perfilar_hijos=0;
+		p_proc->llamadas=NULL;
+		/* los hijos de un proceso que los perfila tambien lo hacen */
+		if (p_proc_actual && p_proc_actual->perfilar_hijos){
+			p_proc->perfilar_hijos=1;
+			crear_perfil(p_proc);
+		}
+		for (i=0; i<MAX_DESC; i++)
+			p_proc->descriptores[i].tuberia=NULL;
+		for (i=0; i<NUM_SEMAFOROS; i++)
+			p_proc->semaforos[i]=0;
+		p_proc->holgura=HOLGURA_DEFECTO;
+		/* init forma el grupo 0; los demas heredan el del padre */
+		entrar_grupo(p_proc, p_proc_actual ? p_proc_actual->gid : 0);
+		//NOTE Practica 3 -> asignando id del padre
+		if(p_proc_actual){
+			p_proc->ppid = p_proc_actual->id;
+			p_proc->holgura = p_proc_actual->holgura;
+			p_proc_actual->num_hijos++;
+			/* el hijo hereda los descriptores abiertos */
+			for (i=0; i<MAX_DESC; i++){
+				p_proc->descriptores[i]=p_proc_actual->descriptores[i];
+				if (p_proc->descriptores[i].tuberia != NULL)
+					abrir_extremo(p_proc->descriptores[i].tuberia,
+						p_proc->descriptores[i].extremo);
+			}
+			/* y los semaforos */
+			for (i=0; i<NUM_SEMAFOROS; i++)
+				if ((p_proc->semaforos[i] = p_proc_actual->semaforos[i]))
+					tabla_semaforos[i].abiertos++;
+		}		
+		/* lo inserta al final de cola de listos */
+		insertar_ultimo(&lista_listos, p_proc);
+		error= 0;
+	}
+	else
+		error= -1; /* fallo al crear imagen */
+
+	return error;
+}
+
+/*
+ *
+ * Rutinas que llevan a cabo las llamadas al sistema
+ *	sis_crear_proceso sis_escribir
+ *
+ */
+
+/*
+ * Tratamiento de llamada al sistema crear_proceso. Llama a la
+ * funcion auxiliar crear_tarea sis_terminar_proceso
+ */
+int sis_crear_proceso(){
+	char *prog;
+	int res;
+
+	printk("-> PROC %d: CREAR PROCESO\n", p_proc_actual->id);
+	prog=(char *)leer_registro(1);
+	res=crear_tarea(prog, TAM_PILA, 0, NULL);
+	return res;
+}
+
+/*
+ * crear_proceso_ext: como crear_proceso pero fijando el tam. de la
+ * pila (0: el de siempre, TAM_PILA)
+ */
+int sis_crear_proceso_ext(){
+	char *prog;
+	int tam_pila;
+
+	prog=(char *)leer_registro(1);
+	tam_pila=(int)leer_registro(2);
+	printk("-> PROC %d: CREAR PROCESO (PILA %d)\n", p_proc_actual->id,
+		tam_pila);
+	if (tam_pila == 0)
+		tam_pila = TAM_PILA;
+	if (tam_pila < TAM_PILA_MIN || tam_pila > TAM_PILA_MAX)
+		return -1;
+	return crear_tarea(prog, tam_pila, 0, NULL);
+}
+
+/*
+ * Argumentos - crear_proceso_args: crea el proceso pasando a su main
+ * los argc argumentos de argv
+ */
+int sis_crear_proceso_args(){
+	static char *sin_argumentos[1] = {NULL};
+	char *prog;
+	int argc;
+	char **argv;
+
+	prog=(char *)leer_registro(1);
+	argc=(int)leer_registro(2);
+	argv=(char **)leer_registro(3);
+	printk("-> PROC %d: CREAR PROCESO (%d ARGUMENTOS)\n", p_proc_actual->id,
+		argc);
+	if (argc == 0)
+		argv = sin_argumentos;	/* main recibe argc 0 */
+	if (tam_argumentos(argc, argv) < 0)
+		return -1;
+	return crear_tarea(prog, TAM_PILA, argc, argv);
+}
+
+/*
+ * Argumentos - argumentos: devuelve argc y deja en *argv el vector
+ * copiado en la pila del proceso. La usa arranque_args.
+ */
+int sis_argumentos(){
+	char ***argv = (char ***)leer_registro(1);
+
+	if (argv != NULL)
+		*argv = p_proc_actual->argv;
+	return p_proc_actual->argc;
+}
+
+/*
+ * Tratamiento de llamada al sistema escribir. Llama simplemente a la
+ * funcion de apoyo escribir_ker
+ */
+int sis_escribir(){
+	char *texto;
+	unsigned int longi;
+
+	texto=(char *)leer_registro(1);
+	longi=(unsigned int)leer_registro(2);
+
+	escribir_ker(texto, longi);
+	return 0;
+}
+
+/*
+ * Tratamiento de llamada al sistema terminar_proceso. Llama a la
+ * funcion auxiliar liberar_proceso
+ */
+int sis_terminar_proceso(){
+	if (p_proc_actual->en_alarma){	/* ha vuelto el manejador */
+		fin_alarma();
+		return 0; /* no debera llegar aqui */
+	}
+	printk("-> FIN PROCESO %d\n", p_proc_actual->id);
+
+	liberar_proceso();
+
+        return 0; /* no debera llegar aqui */
+}
+
+/*
+ * Practica 1 - sis_dormir
+ */
+int sis_dormir(){
+	long int num_ticks = (long int)leer_registro(1);
+ 	if (p_proc_actual != NULL){
+		num_ticks *= PARAMETRO(PARAM_TICK);
+		p_proc_actual->ticks = num_ticks;
+		cambio_proceso(&lista_dormidos);
+	}
+	return 0;
+}
+
+/*
+ * sis_fijar_holgura: fija los ticks que se puede retrasar el despertar
+ * del proceso al dormir para agruparlo con el de otros. Los hijos la
+ * heredan. Devuelve la holgura anterior o -1 si esta fuera de rango.
+ */
+int sis_fijar_holgura(){
+	int holgura = (int)leer_registro(1);
+	int anterior = p_proc_actual->holgura;
+
+	if (holgura < 0 || holgura > HOLGURA_MAX)
+		return -1;
+	p_proc_actual->holgura = holgura;
+	return anterior;
+}
+
+/*
+ * sis_ceder: deja el procesador a los demas listos y pasa al final de
+ * la cola conservando lo que le queda de rodaja
+ */
+int sis_ceder(){
+	cesion_pendiente = 1;
+	cambio_proceso(&lista_listos);
+	return 0;
+}
+
+/*
+ * sis_ceder_a: cede el procesador al proceso listo pid, que ejecuta con
+ * lo que le quedaba de rodaja al que llama. Se pone detras de las
+ * tareas EDF y los envejecidos que ya esten listos, que ejecutan antes
+ * que el; si no hay ninguno cambio_proceso pasa a el directamente. El
+ * que cede va al final con la rodaja completa. Devuelve -1 si pid no
+ * esta listo o si alguno de los dos es una tarea EDF, que solo se
+ * ordenan por plazo.
+ */
+int sis_ceder_a(){
+	int pid = (int)leer_registro(1);
+	BCP *destino;
+	int nivel;
+
+	if (pid == p_proc_actual->id)
+		return 0;
+	if (pid < 0 || pid >= MAX_PROC)
+		return -1;
+	destino = &tabla_procs[pid];
+	nivel = fijar_nivel_int(NIVEL_3);
+	if (destino->estado != LISTO || destino->tiempo_real ||
+	    p_proc_actual->tiempo_real){
+		fijar_nivel_int(nivel);
+		return -1;
+	}
+	eliminar_elem(&lista_listos, destino);
+	insertar_tras_tiempo_real(destino);
+	destino->rodaja = p_proc_actual->rodaja;
+	p_proc_actual->rodaja = PARAMETRO(PARAM_RODAJA);
+	cesion_pendiente = 1;
+	fijar_nivel_int(nivel);
+	cambio_proceso(&lista_listos);
+	return 0;
+}
+
+/*
+ * Practica 0 - retornar el identificador
+ */
+int get_pid() {
+  return p_proc_actual->id;
+}
+
+/*
+ * Practica 3 - Retornar identificador del procs pare
+ */
+int get_ppid(){
+  return p_proc_actual->ppid;
+}
+
+/**
+ * Practica 3 - Espera :
+ *	return 0 -> han acabat d'executar tots els fills 
+ *	return -1 -> encara els fills s'estn executant
+ */
+int espera(){
+	if (p_proc_actual->num_hijos > 0){
+		cambio_proceso(&lista_espera);
+		return 0;
+	} else {
+		return -1;
+	}
+}
+
+/*
+ * Tuberias - crear_tuberia: devuelve en el vector del usuario el
+ * descriptor de lectura y el de escritura de una nueva tuberia
+ */
+int sis_crear_tuberia(){
+	int *desc;
+	int lect, escr;
+	tuberia *tub;
+
+	desc=(int *)leer_registro(1);
+	if (desc == NULL)
+		return -1;
+
+	lect =buscar_desc_libre(p_proc_actual, 0);
+	if (lect < 0)
+		return -1;
+	escr = buscar_desc_libre(p_proc_actual, lect+1);
+	if (escr < 0)
+		return -1;
+
+	tub = reservar_objeto(&cache_tuberias);
+	if (tub == NULL)
+		return -1;	/* no queda memoria para la tuberia */
+
+	tub->ini = 0;
+	tub->num = 0;
+	tub->lectores = 0;
+	tub->escritores = 0;
+	tub->lista_lectores.primero = tub->lista_lectores.ultimo = NULL;
+	tub->lista_escritores.primero = tub->lista_escritores.ultimo = NULL;
+
+	p_proc_actual->descriptores[lect].tuberia = tub;
+	p_proc_actual->descriptores[lect].extremo = LECTURA;
+	abrir_extremo(tub, LECTURA);
+	p_proc_actual->descriptores[escr].tuberia = tub;
+	p_proc_actual->descriptores[escr].extremo = ESCRITURA;
+	abrir_extremo(tub, ESCRITURA);
+
+	desc[0] = lect;
+	desc[1] = escr;
+	return 0;
+}
+
+/*
+ * Tuberias - leer_desc: bloquea mientras la tuberia este vacia y quede
+ * algun escritor. Devuelve los bytes leidos (puede ser menos de los
+ * pedidos), 0 en fin de fichero o -1 si el descriptor no es valido
+ */
+int sis_leer_desc(){
+	int desc, longi, leidos;
+	char *buf;
+	tuberia *tub;
+
+	desc=(int)leer_registro(1);
+	buf=(char *)leer_registro(2);
+	longi=(int)leer_registro(3);
+
+	tub = tuberia_desc(desc, LECTURA);
+	if (tub == NULL || longi < 0)
+		return -1;
+
+	while (tub->num == 0 && tub->escritores > 0)
+		cambio_proceso(&tub->lista_lectores);
+
+	for (leidos=0; leidos<longi && tub->num>0; leidos++){
+		buf[leidos] = tub->buffer[tub->ini];
+		tub->ini = (tub->ini + 1) % TAM_TUBERIA;
+		tub->num--;
+	}
+	if (leidos > 0)
+		despertar_todos(&tub->lista_escritores);
+	return leidos;
+}
+
+/*
+ * Tuberias - escribir_desc: copia todo lo posible y se bloquea cada vez
+ * que la tuberia se llena. Si desaparecen los lectores devuelve lo
+ * escrito hasta entonces, o -1 si no se llego a escribir nada
+ */
+int sis_escribir_desc(){
+	int desc, longi, escritos, fin;
+	char *buf;
+	tuberia *tub;
+
+	desc=(int)leer_registro(1);
+	buf=(char *)leer_registro(2);
+	longi=(int)leer_registro(3);
+
+	tub = tuberia_desc(desc, ESCRITURA);
+	if (tub == NULL || longi < 0)
+		return -1;
+
+	escritos = 0;
+	while (escritos < longi){
+		while (tub->num == TAM_TUBERIA && tub->lectores > 0)
+			cambio_proceso(&tub->lista_escritores);
+		if (tub->lectores == 0)
+			break;
+		for ( ; escritos<longi && tub->num<TAM_TUBERIA; escritos++){
+			fin = (tub->ini + tub->num) % TAM_TUBERIA;
+			tub->buffer[fin] = buf[escritos];
+			tub->num++;
+		}
+		despertar_todos(&tub->lista_lectores);
+	}
+	if (escritos == 0 && longi > 0)
+		return -1;
+	return escritos;
+}
+
+/*
+ * Tuberias - cerrar_desc
+ */
+int sis_cerrar_desc(){
+	int desc;
+	descriptor *d;
+
+	desc=(int)leer_registro(1);
+	if (desc < 0 || desc >= MAX_DESC)
+		return -1;
+	d = &(p_proc_actual->descriptores[desc]);
+	if (d->tuberia == NULL)
+		return -1;
+	cerrar_extremo(d->tuberia, d->extremo);
+	d->tuberia = NULL;
+	return 0;
+}
+
+/*
+ * estadisticas_sistema: copia en la estructura del usuario los
+ * contadores globales del sistema
  */
-static int crear_tarea(char *prog){
-	void * imagen, *pc_inicial;
-	int error=0;
-	int proc;
-	BCP *p_proc;
+int sis_estadisticas_sistema(){
+	estadisticas *est = (estadisticas *)leer_registro(1);
 
-	proc=buscar_BCP_libre();
-	if (proc==-1)
-		return -1;	/* no hay entrada libre */
+	if (est == NULL)
+		return -1;
+	est_sistema.ticks = ticks_sistema;
+	*est = est_sistema;
+	return 0;
+}
 
-	/* A rellenar el BCP ... */
-	p_proc=&(tabla_procs[proc]);
+/*
+ * Semaforos - Crea un semaforo o barrera y lo deja abierto. Devuelve
+ * su id o -1 si el nombre ya existe o no quedan entradas.
+ */
+static int crear_semaforo(char *nombre, int valor, int partes){
+	semaforo *sem = buscar_semaforo(nombre, 1);
+	int j, id;
 
-	/* crea la imagen de memoria leyendo ejecutable */
-	imagen=crear_imagen(prog, &pc_inicial);
-	if (imagen)
-	{
-		p_proc->info_mem=imagen;
-		p_proc->pila=crear_pila(TAM_PILA);
-		fijar_contexto_ini(p_proc->info_mem, p_proc->pila, TAM_PILA,
-			pc_inicial,
-			&(p_proc->contexto_regs));
-		p_proc->id=proc;
-		p_proc->estado=LISTO;
-		p_proc->rodaja=TICKS_POR_RODAJA;
-		p_proc->vueltas=VUELTAS_INIT;
-		p_proc->num_hijos=0;
-		//NOTE Practica 3 -> asignando id del padre
-		if(p_proc_actual){
-			p_proc->ppid = p_proc_actual->id;
-			p_proc_actual->num_hijos++;
-		}		
-		/* lo inserta al final de cola de listos */
-		insertar_ultimo(&lista_listos, p_proc);
-		error= 0;
+	if (sem == NULL || sem->nombre[0] != '\0')
+		return -1;
+	id = sem - tabla_semaforos;
+	for (j=0; (sem->nombre[j] = nombre[j]) != '\0'; j++);
+	sem->valor = valor;
+	sem->partes = partes;
+	sem->llegados = 0;
+	sem->abiertos = 1;
+	sem->bloqueados.primero = sem->bloqueados.ultimo = NULL;
+	p_proc_actual->semaforos[id] = 1;
+	return id;
+}
+
+/*
+ * Semaforos - crear_semaforo: semaforo contador con valor inicial >= 0
+ */
+int sis_crear_semaforo(){
+	char *nombre = (char *)leer_registro(1);
+	int valor = (int)leer_registro(2);
+
+	if (nombre == NULL || valor < 0)
+		return -1;
+	return crear_semaforo(nombre, valor, 0);
+}
+
+/*
+ * Semaforos - crear_barrera: barrera para partes procesos
+ */
+int sis_crear_barrera(){
+	char *nombre = (char *)leer_registro(1);
+	int partes = (int)leer_registro(2);
+
+	if (nombre == NULL || partes < 1)
+		return -1;
+	return crear_semaforo(nombre, 0, partes);
+}
+
+/*
+ * Semaforos - abrir_semaforo: abre un semaforo o barrera existente.
+ * Devuelve su id o -1 si no existe.
+ */
+int sis_abrir_semaforo(){
+	char *nombre = (char *)leer_registro(1);
+	semaforo *sem;
+	int id;
+
+	if (nombre == NULL || (sem = buscar_semaforo(nombre, 0)) == NULL)
+		return -1;
+	id = sem - tabla_semaforos;
+	if (!p_proc_actual->semaforos[id]){
+		p_proc_actual->semaforos[id] = 1;
+		sem->abiertos++;
 	}
-	else
-		error= -1; /* fallo al crear imagen */
+	return id;
+}
 
-	return error;
+/*
+ * Semaforos - cerrar_semaforo
+ */
+int sis_cerrar_semaforo(){
+	int id = (int)leer_registro(1);
+
+	if (semaforo_abierto(id) == NULL)
+		return -1;
+	cerrar_semaforo(p_proc_actual, id);
+	return 0;
 }
 
 /*
- *
- * Rutinas que llevan a cabo las llamadas al sistema
- *	sis_crear_proceso sis_escribir
- *
+ * Semaforos - bajar_semaforo: espera a que el valor sea positivo y lo
+ * decrementa
  */
+int sis_bajar_semaforo(){
+	semaforo *sem = semaforo_abierto((int)leer_registro(1));
+
+	if (sem == NULL || sem->partes > 0)
+		return -1;
+	while (sem->valor == 0)
+		cambio_proceso(&sem->bloqueados);
+	sem->valor--;
+	return 0;
+}
 
 /*
- * Tratamiento de llamada al sistema crear_proceso. Llama a la
- * funcion auxiliar crear_tarea sis_terminar_proceso
+ * Semaforos - subir_semaforo: incrementa el valor y despierta al
+ * primero que espera
  */
-int sis_crear_proceso(){
-	char *prog;
-	int res;
+int sis_subir_semaforo(){
+	semaforo *sem = semaforo_abierto((int)leer_registro(1));
+	int nivel;
 
-	printk("-> PROC %d: CREAR PROCESO\n", p_proc_actual->id);
-	prog=(char *)leer_registro(1);
-	res=crear_tarea(prog);
-	return res;
+	if (sem == NULL || sem->partes > 0)
+		return -1;
+	sem->valor++;
+	if (sem->bloqueados.primero != NULL){
+		nivel = fijar_nivel_int(NIVEL_3);
+		desbloquear(sem->bloqueados.primero, &sem->bloqueados);
+		fijar_nivel_int(nivel);
+	}
+	return 0;
 }
 
 /*
- * Tratamiento de llamada al sistema escribir. Llama simplemente a la
- * funcion de apoyo escribir_ker
+ * Semaforos - esperar_barrera: espera a que lleguen todas las partes.
+ * El ultimo en llegar los libera a todos y recibe 1; los demas 0.
  */
-int sis_escribir(){
-	char *texto;
-	unsigned int longi;
+int sis_esperar_barrera(){
+	semaforo *sem = semaforo_abierto((int)leer_registro(1));
 
-	texto=(char *)leer_registro(1);
-	longi=(unsigned int)leer_registro(2);
+	if (sem == NULL || sem->partes == 0)
+		return -1;
+	if (++(sem->llegados) < sem->partes){
+		cambio_proceso(&sem->bloqueados);
+		return 0;
+	}
+	sem->llegados = 0;
+	liberar_barrera(sem);
+	return 1;
+}
 
-	escribir_ker(texto, longi);
+/*
+ * Grupos - crear_grupo: pasa al proceso a un grupo nuevo, que heredan
+ * los hijos que cree despues. Devuelve su gid.
+ */
+int sis_crear_grupo(){
+	int gid;
+
+	salir_grupo(p_proc_actual);
+	for (gid=0; tabla_grupos[gid].miembros > 0; gid++);	/* siempre hay */
+	entrar_grupo(p_proc_actual, gid);
+	return gid;
+}
+
+/*
+ * Grupos - fijar_grupo: pasa al proceso a un grupo que ya existe.
+ * Devuelve el grupo anterior o -1 si gid no existe.
+ */
+int sis_fijar_grupo(){
+	int gid = (int)leer_registro(1);
+	int anterior = p_proc_actual->gid;
+
+	if (gid < 0 || gid >= MAX_PROC || tabla_grupos[gid].miembros == 0)
+		return -1;
+	if (gid != anterior){
+		salir_grupo(p_proc_actual);
+		entrar_grupo(p_proc_actual, gid);
+	}
+	return anterior;
+}
+
+/*
+ * Grupos - get_gid
+ */
+int get_gid(){
+	return p_proc_actual->gid;
+}
+
+/*
+ * Grupos - matar_grupo: termina a todos los miembros del grupo, el que
+ * llama el ultimo si es uno de ellos. init no se termina nunca, porque
+ * adopta a los huerfanos. Devuelve cuantos ha terminado.
+ */
+int sis_matar_grupo(){
+	int gid = (int)leer_registro(1);
+	BCP *proc, *sig;
+	int suicida = 0, n = 0;
+
+	if (gid < 0 || gid >= MAX_PROC)
+		return -1;
+	for (proc = tabla_grupos[gid].primero; proc != NULL; proc = sig){
+		sig = proc->sig_grupo;
+		if (proc->id == 0)
+			continue;
+		if (proc == p_proc_actual)
+			suicida = 1;
+		else
+			matar_proceso(proc);
+		n++;
+	}
+	if (suicida){
+		printk("-> PROC %d: MATADO CON SU GRUPO\n", p_proc_actual->id);
+		liberar_proceso();
+	}
+	return n;
+}
+
+/*
+ * Grupos - esperar_grupo: se bloquea hasta que no quede ningun miembro
+ * del grupo. La generacion distingue al grupo esperado de otro que
+ * reutilice el gid antes de que el que espera vuelva a ejecutar.
+ * Devuelve -1 si el que llama es del grupo.
+ */
+int sis_esperar_grupo(){
+	int gid = (int)leer_registro(1);
+	unsigned long generacion;
+
+	if (gid < 0 || gid >= MAX_PROC || gid == p_proc_actual->gid)
+		return -1;
+	generacion = tabla_grupos[gid].generacion;
+	while (tabla_grupos[gid].miembros > 0 &&
+	       tabla_grupos[gid].generacion == generacion)
+		cambio_proceso(&tabla_grupos[gid].esperando);
 	return 0;
 }
 
 /*
- * Tratamiento de llamada al sistema terminar_proceso. Llama a la
- * funcion auxiliar liberar_proceso
+ * Reparto - fijar_reparto: fija el peso del grupo (1 a PESO_MAX) y su
+ * cuota en ticks por periodo (0: sin limite). Devuelve -1 si el grupo
+ * no existe o los valores estan fuera de rango.
  */
-int sis_terminar_proceso(){
-	printk("-> FIN PROCESO %d\n", p_proc_actual->id);
+int sis_fijar_reparto(){
+	int gid = (int)leer_registro(1);
+	int peso = (int)leer_registro(2);
+	int cuota = (int)leer_registro(3);
+	grupo *g;
+	int nivel;
 
-	liberar_proceso();
+	if (gid < 0 || gid >= MAX_PROC || tabla_grupos[gid].miembros == 0 ||
+	    peso < 1 || peso > PESO_MAX || cuota < 0)
+		return -1;
+	g = &tabla_grupos[gid];
+	nivel = fijar_nivel_int(NIVEL_3);
+	g->peso = peso;
+	g->cuota = cuota;
+	g->estrangulado = cuota > 0 && g->uso >= cuota;
+	fijar_nivel_int(nivel);
+	/* si el que llama queda estrangulado, deja el procesador */
+	if (estrangulado(p_proc_actual))
+		cambio_proceso(&lista_listos);
+	return 0;
+}
 
-        return 0; /* no debera llegar aqui */
+/*
+ * Reparto - leer_reparto: copia el reparto y el consumo del grupo
+ */
+int sis_leer_reparto(){
+	int gid = (int)leer_registro(1);
+	info_reparto *info = (info_reparto *)leer_registro(2);
+	grupo *g;
+
+	if (gid < 0 || gid >= MAX_PROC || tabla_grupos[gid].miembros == 0 ||
+	    info == NULL)
+		return -1;
+	g = &tabla_grupos[gid];
+	info->peso = g->peso;
+	info->cuota = g->cuota;
+	info->miembros = g->miembros;
+	info->uso = g->uso;
+	info->total = g->total;
+	info->estrangulamientos = g->estrangulamientos;
+	return 0;
 }
 
 /*
- * Practica 1 - sis_dormir
+ * Lotes - procesar_lote: ejecuta en orden las peticiones encoladas en
+ * el anillo del proceso, como si cada una fuera una llamada, y deja sus
+ * resultados en la parte de fines. Para si esta se llena. Una peticion
+ * que bloquea bloquea el lote; procesar_lote no se puede encolar.
+ * Devuelve cuantas peticiones ha ejecutado o -1 si no hay anillo.
  */
-int sis_dormir(){
-	long int num_ticks = (long int)leer_registro(1);
- 	if (p_proc_actual != NULL){
-		num_ticks *= TICK;
-		p_proc_actual->ticks = num_ticks;
-		cambio_proceso(&lista_dormidos);
+int sis_procesar_lote(){
+	anillo_lote *anillo = (anillo_lote *)leer_registro(1);
+	long registros[NUM_ARGS_LOTE];
+	peticion_lote *pet;
+	fin_lote *fin;
+	int i, n = 0;
+	long res;
+
+	if (anillo == NULL)
+		return -1;
+	for (i=0; i<NUM_ARGS_LOTE; i++)
+		registros[i] = leer_registro(i + 1);
+	while (anillo->envio_cabeza != anillo->envio_cola &&
+	       anillo->fin_cola - anillo->fin_cabeza < TAM_ANILLO_LOTE){
+		pet = &anillo->envios[anillo->envio_cabeza % TAM_ANILLO_LOTE];
+		for (i=0; i<NUM_ARGS_LOTE; i++)
+			escribir_registro(i + 1, pet->args[i]);
+		if (pet->servicio == PROCESAR_LOTE)
+			res = -1;
+		else
+			res = ejecutar_servicio(pet->servicio);
+		fin = &anillo->fines[anillo->fin_cola % TAM_ANILLO_LOTE];
+		fin->dato = pet->dato;
+		fin->resultado = res;
+		anillo->envio_cabeza++;
+		anillo->fin_cola++;
+		n++;
+	}
+	for (i=0; i<NUM_ARGS_LOTE; i++)
+		escribir_registro(i + 1, registros[i]);
+	return n;
+}
+
+/*
+ * Tiempo real - fijar_tiempo_real: convierte al proceso en una tarea
+ * periodica EDF con el periodo y presupuesto dados en ticks, o la
+ * devuelve a la clase normal con periodo 0. Falla si la utilizacion
+ * total superaria UTIL_MAX_TIEMPO_REAL.
+ */
+int sis_fijar_tiempo_real(){
+	int periodo = (int)leer_registro(1);
+	int presupuesto = (int)leer_registro(2);
+	int util = 0, anterior = 0;
+
+	if (periodo != 0 && (periodo < 0 || presupuesto <= 0 ||
+	    presupuesto > periodo))
+		return -1;
+	if (periodo != 0)
+		util = utilizacion(periodo, presupuesto);
+	if (p_proc_actual->tiempo_real)
+		anterior = utilizacion(p_proc_actual->periodo,
+			p_proc_actual->presupuesto);
+	if (utilizacion_tiempo_real - anterior + util > UTIL_MAX_TIEMPO_REAL){
+		printk("-> PROC %d: TIEMPO REAL NO ADMITIDO\n", p_proc_actual->id);
+		return -1;
 	}
+	utilizacion_tiempo_real += util - anterior;
+
+	p_proc_actual->tiempo_real = (periodo != 0);
+	p_proc_actual->periodo = periodo;
+	p_proc_actual->presupuesto = presupuesto;
+	p_proc_actual->consumido = 0;
+	p_proc_actual->sin_presupuesto = 0;
+	p_proc_actual->plazo = ticks_sistema + periodo;
+	p_proc_actual->activacion = p_proc_actual->plazo;
+	p_proc_actual->rodaja = PARAMETRO(PARAM_RODAJA);
 	return 0;
 }
 
 /*
- * Practica 0 - retornar el identificador
+ * Tiempo real - esperar_periodo: da por acabado el trabajo del periodo
+ * y espera al siguiente. Devuelve los plazos perdidos hasta ahora.
  */
-int get_pid() {
-  return p_proc_actual->id;
+int sis_esperar_periodo(){
+	if (!p_proc_actual->tiempo_real)
+		return -1;
+	cambio_proceso(&lista_tiempo_real);
+	return p_proc_actual->plazos_perdidos;
 }
 
 /*
- * Practica 3 - Retornar identificador del procs pare
+ * Alarmas - Programa la alarma del proceso para dentro de ticks ticks y
+ * despues cada periodo ticks (0: una sola vez). ticks 0 la anula.
+ * Devuelve los ticks que le faltaban a la anterior.
  */
-int get_ppid(){
-  return p_proc_actual->ppid;
+static int programar_alarma(int ticks, int periodo, void (*manejador)()){
+	int restantes = p_proc_actual->alarma_ticks;
+
+	if (ticks < 0 || periodo < 0 || (ticks > 0 && manejador == NULL))
+		return -1;
+	if (ticks > 0 && p_proc_actual->pila_alarma == NULL){
+		p_proc_actual->pila_alarma = crear_pila(TAM_PILA_ALARMA);
+		if (p_proc_actual->pila_alarma == NULL)
+			return -1;
+		p_proc_actual->memoria += TAM_PILA_ALARMA;
+		memoria_pilas += TAM_PILA_ALARMA;
+	}
+	p_proc_actual->alarma_ticks = ticks;
+	p_proc_actual->alarma_periodo = (ticks > 0) ? periodo : 0;
+	p_proc_actual->manejador = manejador;
+	if (ticks == 0)
+		p_proc_actual->alarma_pendiente = 0;
+	return restantes;
 }
 
-/**
- * Practica 3 - Espera :
- *	return 0 -> han acabat d'executar tots els fills 
- *	return -1 -> encara els fills s'estn executant
+/*
+ * Alarmas - alarma: ejecuta el manejador una vez pasados los ticks
  */
-int espera(){
-	if (p_proc_actual->num_hijos > 0){
-		cambio_proceso(&lista_espera);
-		return 0;
+int sis_alarma(){
+	int ticks = (int)leer_registro(1);
+	void (*manejador)() = (void (*)())leer_registro(2);
+
+	return programar_alarma(ticks, 0, manejador);
+}
+
+/*
+ * Alarmas - temporizador: ejecuta el manejador cada periodo ticks
+ */
+int sis_temporizador(){
+	int periodo = (int)leer_registro(1);
+	void (*manejador)() = (void (*)())leer_registro(2);
+
+	return programar_alarma(periodo, periodo, manejador);
+}
+
+/*
+ * Espera de eventos - esperar_eventos: espera a que ocurra alguno de
+ * los eventos del conjunto o pasen timeout ticks (0: solo consulta,
+ * negativo: sin plazo). Devuelve los eventos ocurridos (EVENTO_TIEMPO
+ * si vence el plazo). Cada EVENTO_HIJO notifica la terminacion de un
+ * solo hijo.
+ */
+int sis_esperar_eventos(){
+	int conjunto = (int)leer_registro(1) & (EVENTO_TECLADO | EVENTO_HIJO);
+	int timeout = (int)leer_registro(2);
+	int nivel, listos;
+
+	if (conjunto == 0 && timeout < 0)
+		return -1;	/* esperaria para siempre */
+
+	nivel = fijar_nivel_int(NIVEL_3);
+	listos = eventos_disponibles(p_proc_actual, conjunto);
+	if (listos == 0 && timeout != 0)
+		listos = esperar_en_fuentes(conjunto, timeout);
+	if (listos > 0 && (listos & EVENTO_HIJO))
+		p_proc_actual->hijos_terminados--;
+	fijar_nivel_int(nivel);
+	return listos;
+}
+
+/*
+ * Espera de eventos - leer_caracter: devuelve el siguiente caracter
+ * recibido por el terminal, esperando si no hay ninguno
+ */
+int sis_leer_caracter(){
+	int nivel, car;
+
+	nivel = fijar_nivel_int(NIVEL_3);
+	while (num_teclado == 0)
+		if (esperar_en_fuentes(EVENTO_TECLADO, -1) < 0){
+			fijar_nivel_int(nivel);
+			return -1;
+		}
+	car = buffer_teclado[ini_teclado];
+	ini_teclado = (ini_teclado + 1) % TAM_BUF_TECLADO;
+	num_teclado--;
+	fijar_nivel_int(nivel);
+	return car;
+}
+
+/*
+ * memoria_sistema: rellena la estructura del usuario con la memoria
+ * que ocupan las pilas de los procesos y los objetos del kernel. El
+ * HAL no da el tam. de las imagenes, que ademas se comparten entre
+ * los procesos de un mismo programa, asi que no se incluyen.
+ */
+int sis_memoria_sistema(){
+	info_memoria *mem = (info_memoria *)leer_registro(1);
+	cache_objetos *c;
+	info_cache *cache;
+	int i, j;
+
+	if (mem == NULL)
+		return -1;
+	mem->procesos = 0;
+	for (i=0; i<MAX_PROC; i++)
+		if (tabla_procs[i].estado != NO_USADA)
+			mem->procesos++;
+	mem->pilas = memoria_pilas;
+	mem->proceso = p_proc_actual->memoria;
+	mem->reserva = (long)num_reserva * TAM_PILA;
+	mem->tabla_procesos = sizeof(tabla_procs);
+	mem->arena = sizeof(arena_kernel);
+	mem->arena_usada = arena_usada;
+	mem->objetos = 0;
+	mem->num_caches = 0;
+	for (i=0; i<num_caches; i++){
+		c = tabla_caches[i];
+		mem->objetos += (long)c->en_uso * c->tam_obj;
+		if (i >= NUM_CACHES_INFO)
+			continue;
+		cache = &mem->caches[mem->num_caches++];
+		for (j=0; j<MAX_NOMBRE_CACHE-1 && c->nombre[j] != '\0'; j++)
+			cache->nombre[j] = c->nombre[j];
+		cache->nombre[j] = '\0';
+		cache->tam_obj = c->tam_obj;
+		cache->slabs = c->num_slabs;
+		cache->en_uso = c->en_uso;
+		cache->max_en_uso = c->max_en_uso;
+		cache->asignaciones = c->asignaciones;
+		cache->fallos = c->fallos;
+	}
+	return 0;
+}
+
+/*
+ * Parametros - leer_parametro: devuelve el valor del parametro o -1
+ * si no existe
+ */
+int sis_leer_parametro(){
+	int n = (int)leer_registro(1);
+
+	if (n < 0 || n >= NUM_PARAMETROS)
+		return -1;
+	return PARAMETRO(n);
+}
+
+/*
+ * Parametros - fijar_parametro: cambia el valor del parametro si esta
+ * en su rango. Los procesos lo notan al recargar la rodaja o al
+ * castigarse; el cambio de frecuencia reprograma el reloj. El tick debe
+ * ser multiplo de MUESTRAS_CARGA_POR_SEG para que la carga media se
+ * muestree justo cada decima de segundo.
+ */
+int sis_fijar_parametro(){
+	int n = (int)leer_registro(1);
+	int valor = (int)leer_registro(2);
+
+	if (n < 0 || n >= NUM_PARAMETROS ||
+	    valor < tabla_parametros[n].minimo ||
+	    valor > tabla_parametros[n].maximo ||
+	    (n == PARAM_TICK && valor % MUESTRAS_CARGA_POR_SEG != 0))
+		return -1;
+	printk("-> PROC %d: PARAMETRO %s = %d\n", p_proc_actual->id,
+		tabla_parametros[n].nombre, valor);
+	PARAMETRO(n) = valor;
+	if (n == PARAM_TICK)
+		iniciar_cont_reloj(valor);
+	return 0;
+}
+
+/*
+ * Envejecimiento - esperas_listos: copia en info la espera en la cola
+ * de listos de hasta max procesos existentes. Devuelve cuantos ha
+ * copiado.
+ */
+int sis_esperas_listos(){
+	info_espera *info = (info_espera *)leer_registro(1);
+	int max = (int)leer_registro(2);
+	unsigned long actual;
+	BCP *proc;
+	int i, n = 0;
+
+	if (info == NULL || max < 0)
+		return -1;
+	for (i=0; i<MAX_PROC && n<max; i++){
+		proc = &tabla_procs[i];
+		if (proc->estado == NO_USADA || proc->estado == ZOMBI)
+			continue;
+		info[n].id = proc->id;
+		info[n].estado = proc->estado;
+		info[n].veces = proc->veces_listo;
+		info[n].media = proc->veces_listo ?
+			proc->espera_total / proc->veces_listo : 0;
+		info[n].maxima = proc->espera_max;
+		if (proc->estado == LISTO){
+			actual = ticks_sistema - proc->listo_desde;
+			if (actual > info[n].maxima)
+				info[n].maxima = actual;
+		}
+		info[n].envejecimientos = proc->envejecimientos;
+		n++;
+	}
+	return n;
+}
+
+/*
+ * Perfil - iniciar_perfil: con PERFIL_PROCESO empieza de cero el perfil
+ * del proceso y con PERFIL_HIJOS hace que se perfilen los hijos que
+ * cree a partir de ahora. Con 0 vuelca y libera el perfil. Devuelve -1
+ * si el modo no es valido o no hay memoria.
+ */
+int sis_iniciar_perfil(){
+	int modo = (int)leer_registro(1);
+
+	if (modo & ~(PERFIL_PROCESO | PERFIL_HIJOS))
+		return -1;
+	if (modo & PERFIL_PROCESO){
+		if (crear_perfil(p_proc_actual) < 0)
+			return -1;
+	} else
+		liberar_perfil(p_proc_actual);
+	p_proc_actual->perfilar_hijos = (modo & PERFIL_HIJOS) != 0;
+	return 0;
+}
+
+/*
+ * Perfil - leer_perfil: copia el perfil del proceso que llama. Devuelve
+ * -1 si no se le esta perfilando.
+ */
+int sis_leer_perfil(){
+	info_perfil *perfil = (info_perfil *)leer_registro(1);
+
+	if (perfil == NULL || p_proc_actual->perfil == NULL)
+		return -1;
+	*perfil = *(p_proc_actual->perfil);
+	return 0;
+}
+
+/*
+ * Traza de llamadas - Devuelve el proceso pid si esta vivo
+ */
+static BCP * proceso_vivo(int pid){
+	if (pid < 0 || pid >= MAX_PROC || tabla_procs[pid].estado == NO_USADA ||
+	    tabla_procs[pid].estado == ZOMBI)
+		return NULL;
+	return &tabla_procs[pid];
+}
+
+/*
+ * Traza de llamadas - trazar: anota desde ahora las llamadas del
+ * proceso pid cuyo bit este en la mascara. Si ya se le trazaba solo
+ * cambia la mascara; con 0 deja de trazarlo y tira lo no leido.
+ * Devuelve -1 si el proceso no existe o no hay memoria.
+ */
+int sis_trazar(){
+	int pid = (int)leer_registro(1);
+	unsigned long mascara = (unsigned long)leer_registro(2);
+	anillo_llamadas *anillo;
+	BCP *proc;
+	int nivel;
+
+	if ((proc = proceso_vivo(pid)) == NULL)
+		return -1;
+	nivel = fijar_nivel_int(NIVEL_3);
+	if (mascara == 0){
+		if (proc->llamadas != NULL){
+			proc->llamadas->num = 0;
+			liberar_anillo(proc);
+		}
+	} else if (proc->llamadas != NULL)
+		proc->llamadas->mascara = mascara;
+	else if ((anillo = reservar_objeto(&cache_anillos)) != NULL){
+		anillo->mascara = mascara;
+		anillo->anotadas = 0;
+		anillo->primera = anillo->num = 0;
+		proc->llamadas = anillo;
 	} else {
+		fijar_nivel_int(nivel);
+		return -1;
+	}
+	fijar_nivel_int(nivel);
+	return 0;
+}
+
+/*
+ * Traza de llamadas - leer_traza: saca del anillo del proceso pid hasta
+ * max llamadas, de la mas antigua a la mas reciente. Devuelve cuantas
+ * copia o -1 si no se le esta trazando.
+ */
+int sis_leer_traza(){
+	int pid = (int)leer_registro(1);
+	info_llamada *llamadas = (info_llamada *)leer_registro(2);
+	int max = (int)leer_registro(3);
+	anillo_llamadas *anillo;
+	BCP *proc;
+	int n, nivel;
+
+	if ((proc = proceso_vivo(pid)) == NULL || llamadas == NULL)
+		return -1;
+	nivel = fijar_nivel_int(NIVEL_3);
+	if ((anillo = proc->llamadas) == NULL){
+		fijar_nivel_int(nivel);
 		return -1;
 	}
+	for (n=0; n<max && anillo->num>0; n++){
+		llamadas[n] = anillo->registros[anillo->primera];
+		anillo->primera = (anillo->primera + 1) % TAM_ANILLO_LLAMADAS;
+		anillo->num--;
+	}
+	fijar_nivel_int(nivel);
+	return n;
 }
 
 /*
@@ -532,6 +3061,10 @@ int espera(){
 int main(){
 	/* se llega con las interrupciones prohibidas */
 	iniciar_tabla_proc();
+	iniciar_cache(&cache_tuberias, "tuberias", sizeof(tuberia));
+	iniciar_cache(&cache_nodos_espera, "nodos_espera", sizeof(nodo_espera));
+	iniciar_cache(&cache_perfiles, "perfiles", sizeof(info_perfil));
+	iniciar_cache(&cache_anillos, "anillos_llamadas", sizeof(anillo_llamadas));
 
 	instal_man_int(EXC_ARITM, exc_arit); 
 	instal_man_int(EXC_MEM, exc_mem); 
@@ -541,15 +3074,16 @@ int main(){
 	instal_man_int(INT_SW, int_sw); 
 
 	iniciar_cont_int();		/* inicia cont. interr. */
-	iniciar_cont_reloj(TICK);	/* fija frecuencia del reloj */
+	iniciar_cont_reloj(PARAMETRO(PARAM_TICK));	/* fija frecuencia del reloj */
 	iniciar_cont_teclado();		/* inici cont. teclado */
 	
 	/* crea proceso inicial */
-	if (crear_tarea((void *)"init")<0)
+	if (crear_tarea((void *)"init", TAM_PILA, 0, NULL)<0)
 		panico("no encontrado el proceso inicial");
 	
 	/* activa proceso inicial */
 	p_proc_actual=planificador();
+	contar_espera_listo(p_proc_actual);
 	/* NOTE Prctica 3 : asignacin inicial como proceso padre con 0 hijos */
 	p_proc_actual->ppid = -1;
 	p_proc_actual->num_hijos = 0;
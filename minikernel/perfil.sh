@@ -0,0 +1,78 @@
+## Convierte los perfiles que vuelca el kernel en un perfil plano por
+## funcion, resolviendo las direcciones con nm sobre cada imagen
+##
+## Uso (desde el directorio en que se arranco el sistema, ya que las
+## rutas de las imagenes son relativas a el):
+##	boot/boot minikernel/kernel > out.out
+##	sh minikernel/perfil.sh out.out
+##
+## El kernel vuelca "#PERFIL pid imagen muestras en_kernel fuera" y una
+## linea "#CUBETA pid desde hasta muestras" por cubeta no vacia, con las
+## direcciones en hexadecimal relativas a la base de la imagen. Cada
+## cubeta se atribuye a la funcion que contiene su primera direccion.
+
+set -e
+
+tr -d '\r' < "$1" | awk '
+function hex(cad,   i, n) {
+	n = 0;
+	cad = tolower(cad);
+	for (i = 1; i <= length(cad); i++)
+		n = n * 16 + index("0123456789abcdef", substr(cad, i, 1)) - 1;
+	return n;
+}
+function cargar(img,   cmd, l, c) {
+	if (img in simbolos)
+		return;
+	simbolos[img] = 0;
+	cmd = "nm -n --defined-only " img " 2>/dev/null";
+	while ((cmd | getline l) > 0) {
+		split(l, c, " ");
+		if (c[2] !~ /^[tTwW]$/)
+			continue;
+		n = ++simbolos[img];
+		dir[img, n] = hex(c[1]);
+		nombre[img, n] = c[3];
+	}
+	close(cmd);
+}
+function funcion(img, d,   i, r) {
+	r = "??";
+	for (i = 1; i <= simbolos[img] && dir[img, i] <= d; i++)
+		r = nombre[img, i];
+	return r;
+}
+{
+	i = index($0, "#PERFIL ");
+	if (i > 0) {
+		split(substr($0, i + 8), c, " ");
+		imagen[c[1]] = c[2];
+		cargar(c[2]);
+		printf("%s %s 0 %d muestras, %d en el kernel, %d fuera (%s)\n",
+			c[1], c[3] + 1, c[3], c[4], c[5], c[2]);
+		total[c[1]] = c[3];
+		next;
+	}
+	i = index($0, "#CUBETA ");
+	if (i > 0) {
+		split(substr($0, i + 8), c, " ");
+		f = funcion(imagen[c[1]], hex(c[2]));
+		cuenta[c[1], f] += c[4];
+	}
+}
+END {
+	for (k in cuenta) {
+		split(k, c, SUBSEP);
+		printf("%s %d 1 %6.2f%% %8d  %s\n", c[1], cuenta[k],
+			total[c[1]] ? 100 * cuenta[k] / total[c[1]] : 0,
+			cuenta[k], c[2]);
+	}
+}' | sort -k1,1n -k3,3n -k2,2nr | awk '
+{
+	if ($1 != pid)
+		printf("\nproceso %s:", $1);
+	pid = $1;
+	$1 = $2 = $3 = "";
+	sub(/^ +/, "");
+	print " " $0;
+}'
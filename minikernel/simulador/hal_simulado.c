@@ -0,0 +1,317 @@
+/*
+ *  minikernel/simulador/hal_simulado.c
+ *
+ * HAL simulado con el que kernel.c se ejecuta como un programa normal
+ * del host, sin senales ni temporizadores reales:
+ *
+ *  - Los contextos son ucontext_t y cambio_contexto usa swapcontext.
+ *    El nivel de interrupcion, el modo y los registros viajan con cada
+ *    contexto, como en el HAL real.
+ *  - El reloj es virtual: avanza un tick cada vez que un proceso
+ *    simulado consume uno con calcular o el kernel espera en halt.
+ *  - Las interrupciones se entregan llamando al manejador instalado
+ *    con el nivel de su vector; la int. SW queda pendiente hasta que el
+ *    nivel baja de NIVEL_1.
+ *  - crear_imagen busca el programa en el simulador; cuando se libera
+ *    la ultima imagen termina la simulacion, como termina el sistema.
+ *  - liberar_pila rellena la pila con VENENO_PILA antes de liberarla:
+ *    si el kernel libera la pila sobre la que ejecuta, falla enseguida
+ *    en vez de cuando alguien reutilice esa memoria.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <dlfcn.h>
+
+#include "HAL.h"
+#include "const.h"
+#include "llamsis.h"
+#include "simulador.h"
+
+/* main de kernel.c, renombrado al compilarlo para el simulador */
+int arrancar_kernel();
+
+contadores_sim contadores;
+int salida_kernel = 0;
+
+static void (*manejadores[NVECTORES])();
+static int nivel = NIVEL_3;	/* se arranca con las interrupciones prohibidas */
+static int modo_usuario = 0;	/* modo en que ejecuta el procesador */
+static int modo_previo = 0;	/* modo que interrumpio el manejador en curso */
+static int sw_pendiente = 0;
+static long registros[NREGS];
+static int frecuencia = TICK;
+
+/* Cabecera de cada pila con su tamano, para envenenarla al liberarla */
+#define CABECERA_PILA 16
+#define VENENO_PILA 0xdb
+
+static int imagenes = 0;
+static ucontext_t contexto_simulador;
+static unsigned long limite_ticks = 0;
+static int por_limite = 0;
+
+/*
+ * Vuelve a simular: la simulacion ha terminado
+ */
+static void terminar_simulacion(){
+	setcontext(&contexto_simulador);
+}
+
+/*
+ * Ejecuta el manejador del vector con el nivel dado (o el actual si es
+ * mayor) en modo kernel y, al volver, entrega la int. SW si el nivel
+ * restaurado lo permite
+ */
+static void entregar_sw();
+
+static void interrumpir(int vector, int nivel_int){
+	int nivel_guardado = nivel;
+	int modo_guardado = modo_usuario, previo_guardado = modo_previo;
+
+	if (manejadores[vector] == NULL)
+		panico("interrupcion sin manejador");
+	if (nivel_int > nivel)
+		nivel = nivel_int;
+	modo_previo = modo_usuario;
+	modo_usuario = 0;
+	manejadores[vector]();
+	nivel = nivel_guardado;
+	modo_usuario = modo_guardado;
+	modo_previo = previo_guardado;
+	entregar_sw();
+}
+
+static void entregar_sw(){
+	while (sw_pendiente && nivel < NIVEL_1){
+		sw_pendiente = 0;
+		contadores.ints_sw++;
+		interrumpir(INT_SW, NIVEL_1);
+	}
+}
+
+/*
+ * Un tick de reloj. Al llegar al limite se da por terminada la
+ * simulacion.
+ */
+static void tick(){
+	if (limite_ticks && contadores.ticks >= limite_ticks){
+		por_limite = 1;
+		terminar_simulacion();
+	}
+	contadores.ticks++;
+	interrumpir(INT_RELOJ, NIVEL_3);
+}
+
+/*
+ * Arranque de los contextos creados con fijar_contexto_ini: la
+ * direccion inicial llega partida en dos int por makecontext
+ */
+static void arranque(unsigned int alta, unsigned int baja){
+	void (*inicio)() = (void (*)())(((unsigned long)alta << 32) | baja);
+
+	nivel = 0;
+	modo_usuario = 1;
+	entregar_sw();
+	inicio();
+	llamada(TERMINAR_PROCESO, 0);
+	panico("terminar_proceso ha vuelto");
+}
+
+/*
+ *
+ * Funciones del HAL
+ *
+ */
+
+unsigned long long int leer_reloj_CMOS(){
+	return contadores.ticks / frecuencia;
+}
+
+void iniciar_cont_reloj(int ticks_por_seg){
+	frecuencia = ticks_por_seg;
+}
+
+void iniciar_cont_teclado(){
+}
+
+void iniciar_cont_int(){
+}
+
+void instal_man_int(int nvector, void (*manej)()){
+	manejadores[nvector] = manej;
+}
+
+int fijar_nivel_int(int nuevo){
+	int anterior = nivel;
+
+	nivel = nuevo;
+	entregar_sw();
+	return anterior;
+}
+
+int viene_de_modo_usuario(){
+	return modo_previo;
+}
+
+void activar_int_SW(){
+	sw_pendiente = 1;
+	entregar_sw();
+}
+
+void cambio_contexto(contexto_t *contexto_a_salvar,
+		contexto_t *contexto_a_restaurar){
+	int nivel_guardado = nivel;
+	int modo_guardado = modo_usuario, previo_guardado = modo_previo;
+
+	contadores.cambios++;
+	if (contexto_a_salvar == NULL)
+		setcontext(&contexto_a_restaurar->ctxt);
+	memcpy(contexto_a_salvar->registros, registros, sizeof(registros));
+	swapcontext(&contexto_a_salvar->ctxt, &contexto_a_restaurar->ctxt);
+	/* se vuelve aqui cuando alguien restaura este contexto */
+	memcpy(registros, contexto_a_salvar->registros, sizeof(registros));
+	nivel = nivel_guardado;
+	modo_usuario = modo_guardado;
+	modo_previo = previo_guardado;
+}
+
+void * crear_imagen(char *prog, void **dir_ini){
+	void *inicio = buscar_programa(prog);
+
+	if (inicio == NULL)
+		return NULL;
+	*dir_ini = inicio;
+	imagenes++;
+	/* dlinfo y dlsym del kernel ven el propio simulador */
+	return dlopen(NULL, RTLD_LAZY);
+}
+
+void * crear_pila(int tam){
+	char *mem = malloc(CABECERA_PILA + tam);
+
+	if (mem == NULL)
+		return NULL;
+	*(int *)mem = tam;
+	return mem + CABECERA_PILA;
+}
+
+void fijar_contexto_ini(void *mem, void *p_pila, int tam_pila,
+			void * pc_inicial, contexto_t *contexto_ini){
+	unsigned long pc = (unsigned long)pc_inicial;
+
+	getcontext(&contexto_ini->ctxt);
+	contexto_ini->ctxt.uc_stack.ss_sp = p_pila;
+	contexto_ini->ctxt.uc_stack.ss_size = tam_pila;
+	contexto_ini->ctxt.uc_link = NULL;
+	makecontext(&contexto_ini->ctxt, (void (*)())arranque, 2,
+		(unsigned int)(pc >> 32), (unsigned int)pc);
+	memset(contexto_ini->registros, 0, sizeof(contexto_ini->registros));
+}
+
+void liberar_imagen(void *mem){
+	dlclose(mem);
+	if (--imagenes == 0)
+		terminar_simulacion();
+}
+
+void liberar_pila(void *pila){
+	char *mem = (char *)pila - CABECERA_PILA;
+
+	memset(pila, VENENO_PILA, *(int *)mem);
+	free(mem);
+}
+
+long leer_registro(int nreg){
+	return registros[nreg];
+}
+
+int escribir_registro(int nreg, long valor){
+	registros[nreg] = valor;
+	return 0;
+}
+
+char leer_puerto(int dir_puerto){
+	return 0;
+}
+
+/*
+ * El kernel espera una interrupcion: la unica fuente es el reloj
+ */
+void halt(){
+	if (nivel >= NIVEL_3)
+		panico("halt con el reloj inhibido");
+	contadores.parado++;
+	tick();
+}
+
+void panico(char *mens){
+	fprintf(stderr, "PANICO: %s\n", mens);
+	exit(1);
+}
+
+void escribir_ker(char *buffer, unsigned int longi){
+	if (salida_kernel)
+		fwrite(buffer, 1, longi, stdout);
+}
+
+int printk(const char *formato, ...){
+	va_list args;
+	int n;
+
+	if (!salida_kernel)
+		return 0;
+	va_start(args, formato);
+	n = vfprintf(stdout, formato, args);
+	va_end(args);
+	return n;
+}
+
+/*
+ *
+ * Funciones para el programa de simulacion
+ *
+ */
+
+int simular(unsigned long limite){
+	ucontext_t contexto_arranque;
+	void *pila = malloc(TAM_PILA);
+
+	limite_ticks = limite;
+	por_limite = 0;
+	getcontext(&contexto_arranque);
+	contexto_arranque.uc_stack.ss_sp = pila;
+	contexto_arranque.uc_stack.ss_size = TAM_PILA;
+	contexto_arranque.uc_link = NULL;
+	makecontext(&contexto_arranque, (void (*)())arrancar_kernel, 0);
+	swapcontext(&contexto_simulador, &contexto_arranque);
+	/* la pila de arranque la siguen usando el kernel y espera_int */
+	return por_limite;
+}
+
+void calcular(int ticks){
+	while (ticks-- > 0)
+		tick();
+}
+
+long llamada(int nserv, int nargs, ...){
+	va_list args;
+	int i;
+
+	va_start(args, nargs);
+	registros[0] = nserv;
+	for (i=1; i<=nargs && i<NREGS; i++)
+		registros[i] = va_arg(args, long);
+	va_end(args);
+	contadores.llamadas++;
+	interrumpir(LLAM_SIS, nivel);
+	return registros[0];
+}
+
+int frecuencia_reloj(){
+	return frecuencia;
+}
@@ -0,0 +1,258 @@
+/*
+ *  minikernel/simulador/simulador.c
+ *
+ * Simulador del planificador en el host: ejecuta el kernel.c real
+ * sobre el HAL simulado con una carga sintetica y resume rendimiento,
+ * equidad y esperas en listos. Se construye con "make simulador" en
+ * minikernel y no necesita boot ni los programas de usuario.
+ *
+ *	simulador/simulador [-c calculo] [-i interactivos] [-d demanda]
+ *		[-r rodaja] [-e envejecimiento] [-s semilla] [-l limite] [-v]
+ *
+ * La carga la forman procesos de calculo, que consumen su demanda de
+ * ticks con una llamada barata cada rafaga larga, y procesos
+ * interactivos, que alternan rafagas de 1 a 3 ticks con esperas de 1 a
+ * 10 ticks (esperar_eventos sin eventos). init fija los parametros
+ * pedidos, los crea a todos y los espera.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "const.h"
+#include "llamsis.h"
+#include "simulador.h"
+
+#define CALCULO 0
+#define INTERACTIVO 1
+#define NUM_CLASES 2
+
+static char *nombres_clase[NUM_CLASES] = {"calculo", "interactivo"};
+
+/* Lo que init encarga a cada trabajo y lo que este mide de si mismo */
+typedef struct {
+	int clase;
+	unsigned long creado;		/* tick en que init lo creo */
+	unsigned long fin;		/* tick en que termino */
+	unsigned long veces;		/* de listo a ejecucion */
+	unsigned long espera_media;	/* en listos, segun el kernel */
+	unsigned long espera_max;
+} trabajo;
+
+/* Opciones de la simulacion */
+static int num_clase[NUM_CLASES] = {4, 4};
+static int demanda = 20000;
+static int rodaja = 0;			/* 0: el valor por defecto */
+static int envejecimiento = -1;		/* -1: el valor por defecto */
+static unsigned int semilla = 1;
+static unsigned long limite = 0;
+
+static trabajo trabajos[MAX_PROC];
+static int num_trabajos = 0;
+static int siguiente_trabajo = 0;	/* el proximo que arranca */
+static estadisticas est;
+
+/*
+ * Generador pseudoaleatorio de cada trabajo (xorshift), para que la
+ * carga no dependa del orden en que ejecutan
+ */
+static unsigned int aleatorio(unsigned int *estado, unsigned int max){
+	unsigned int x = *estado;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*estado = x;
+	return x % max;
+}
+
+/*
+ * Anota en el trabajo su espera en listos antes de terminar
+ */
+static void medir_esperas(trabajo *t){
+	info_espera info[MAX_PROC];
+	int pid = (int)llamada(GET_PID, 0);
+	int i, n;
+
+	n = (int)llamada(ESPERAS_LISTOS, 2, (long)info, (long)MAX_PROC);
+	for (i=0; i<n; i++)
+		if (info[i].id == pid){
+			t->veces = info[i].veces;
+			t->espera_media = info[i].media;
+			t->espera_max = info[i].maxima;
+		}
+}
+
+/*
+ * Programa "trabajo": los trabajos arrancan en el orden en que init los
+ * crea porque la cola de listos es FIFO
+ */
+static void programa_trabajo(){
+	trabajo *t = &trabajos[siguiente_trabajo++];
+	unsigned int estado = semilla * 2654435761U + (t - trabajos) + 1;
+	int hecho = 0, rafaga;
+
+	while (hecho < demanda){
+		if (t->clase == CALCULO)
+			rafaga = 50 + aleatorio(&estado, 200);
+		else
+			rafaga = 1 + aleatorio(&estado, 3);
+		if (rafaga > demanda - hecho)
+			rafaga = demanda - hecho;
+		calcular(rafaga);
+		hecho += rafaga;
+		if (t->clase == CALCULO)
+			llamada(GET_PID, 0);
+		else
+			llamada(ESPERAR_EVENTOS, 2, 0L,
+				(long)(1 + aleatorio(&estado, 10)));
+	}
+	medir_esperas(t);
+	t->fin = contadores.ticks;
+}
+
+/*
+ * Programa "init": prepara el kernel, crea los trabajos intercalando
+ * las clases y los espera
+ */
+static void programa_init(){
+	int clase, i;
+
+	if (rodaja > 0)
+		llamada(FIJAR_PARAMETRO, 2, (long)PARAM_RODAJA, (long)rodaja);
+	if (envejecimiento >= 0)
+		llamada(FIJAR_PARAMETRO, 2, (long)PARAM_ENVEJECIMIENTO,
+			(long)envejecimiento);
+	for (i=0; i<num_clase[CALCULO] || i<num_clase[INTERACTIVO]; i++)
+		for (clase=0; clase<NUM_CLASES; clase++){
+			if (i >= num_clase[clase] || num_trabajos == MAX_PROC-1)
+				continue;
+			trabajos[num_trabajos].clase = clase;
+			trabajos[num_trabajos].creado = contadores.ticks;
+			if (llamada(CREAR_PROCESO, 1, (long)"trabajo") == 0)
+				num_trabajos++;
+		}
+	while (llamada(ESPERA, 0) >= 0);
+	llamada(ESTADISTICAS_SISTEMA, 1, (long)&est);
+}
+
+void * buscar_programa(char *nombre){
+	if (strcmp(nombre, "init") == 0)
+		return programa_init;
+	if (strcmp(nombre, "trabajo") == 0)
+		return programa_trabajo;
+	return NULL;
+}
+
+/*
+ * Indice de equidad de Jain de n valores: 1 si son todos iguales, 1/n
+ * si uno se lo lleva todo
+ */
+static double indice_jain(double *x, int n){
+	double suma = 0, cuadrados = 0;
+	int i;
+
+	for (i=0; i<n; i++){
+		suma += x[i];
+		cuadrados += x[i] * x[i];
+	}
+	return cuadrados > 0 ? suma * suma / (n * cuadrados) : 1;
+}
+
+/*
+ * Resumen de una clase (o de todas con clase < 0): ralentizacion
+ * (tiempo de retorno / demanda), su equidad y las esperas en listos
+ */
+static void resumir(int clase){
+	double ralentizacion[MAX_PROC], retorno = 0, espera = 0;
+	unsigned long espera_max = 0;
+	int i, n = 0;
+
+	for (i=0; i<num_trabajos; i++){
+		if ((clase >= 0 && trabajos[i].clase != clase) ||
+		    trabajos[i].fin == 0)
+			continue;
+		ralentizacion[n] = (double)(trabajos[i].fin -
+			trabajos[i].creado) / demanda;
+		retorno += trabajos[i].fin - trabajos[i].creado;
+		espera += trabajos[i].espera_media;
+		if (trabajos[i].espera_max > espera_max)
+			espera_max = trabajos[i].espera_max;
+		n++;
+	}
+	if (n == 0)
+		return;
+	fprintf(stdout, "%-12s %3d %10.0f %8.2f %6.3f %9.1f %9lu\n",
+		clase >= 0 ? nombres_clase[clase] : "todos", n, retorno / n,
+		retorno / n / demanda,
+		indice_jain(ralentizacion, n), espera / n, espera_max);
+}
+
+static void uso(char *prog){
+	fprintf(stderr, "uso: %s [-c calculo] [-i interactivos] [-d demanda] "
+		"[-r rodaja] [-e envejecimiento] [-s semilla] [-l limite] "
+		"[-v]\n", prog);
+	exit(1);
+}
+
+int main(int argc, char *argv[]){
+	struct timespec t0, t1;
+	unsigned long eventos, terminados = 0;
+	double real, segundos;
+	int opcion, cortada, i;
+
+	while ((opcion = getopt(argc, argv, "c:i:d:r:e:s:l:v")) != -1)
+		switch (opcion){
+		case 'c': num_clase[CALCULO] = atoi(optarg); break;
+		case 'i': num_clase[INTERACTIVO] = atoi(optarg); break;
+		case 'd': demanda = atoi(optarg); break;
+		case 'r': rodaja = atoi(optarg); break;
+		case 'e': envejecimiento = atoi(optarg); break;
+		case 's': semilla = (unsigned int)atoi(optarg); break;
+		case 'l': limite = strtoul(optarg, NULL, 10); break;
+		case 'v': salida_kernel = 1; break;
+		default: uso(argv[0]);
+		}
+	if (demanda <= 0 || num_clase[CALCULO] < 0 || num_clase[INTERACTIVO] < 0)
+		uso(argv[0]);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	cortada = simular(limite);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	real = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	segundos = (double)contadores.ticks / frecuencia_reloj();
+	eventos = contadores.ticks + contadores.llamadas + contadores.ints_sw;
+	for (i=0; i<num_trabajos; i++)
+		if (trabajos[i].fin != 0)
+			terminados++;
+
+	fprintf(stdout, "simulados %lu ticks (%.1f s)%s: %lu llamadas, "
+		"%lu ints. SW, %lu cambios de contexto\n", contadores.ticks,
+		segundos, cortada ? ", cortada por el limite" : "",
+		contadores.llamadas, contadores.ints_sw, contadores.cambios);
+	fprintf(stdout, "tiempo real %.3f s: %.2f millones de eventos/s, "
+		"%.0fx tiempo real\n", real, eventos / real / 1e6,
+		real > 0 ? segundos / real : 0);
+	fprintf(stdout, "procesador ocupado %.1f%%, %lu de %d trabajos "
+		"terminados (%.4f por segundo simulado)\n",
+		contadores.ticks ? 100.0 * (contadores.ticks - contadores.parado) /
+		contadores.ticks : 0, terminados, num_trabajos,
+		segundos > 0 ? terminados / segundos : 0);
+	if (!cortada)
+		fprintf(stdout, "cambios: dormir %lu espera %lu bloqueo %lu "
+			"fin %lu expulsion %lu ceder %lu\n",
+			est.cambios[CAUSA_DORMIR], est.cambios[CAUSA_ESPERA],
+			est.cambios[CAUSA_BLOQUEO], est.cambios[CAUSA_FIN],
+			est.cambios[CAUSA_EXPULSION], est.cambios[CAUSA_CEDER]);
+	fprintf(stdout, "\n%-12s %3s %10s %8s %6s %9s %9s\n", "clase", "n",
+		"retorno", "ralent.", "jain", "espera", "esp.max");
+	for (i=0; i<NUM_CLASES; i++)
+		resumir(i);
+	resumir(-1);
+	return 0;
+}
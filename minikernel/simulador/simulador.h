@@ -0,0 +1,51 @@
+/*
+ *  minikernel/simulador/simulador.h
+ *
+ * Interfaz entre el HAL simulado (hal_simulado.c) y el programa que
+ * conduce la simulacion (simulador.c). Los "procesos" simulados son
+ * funciones del propio simulador que ejecutan en las pilas que crea el
+ * kernel: consumen ticks con calcular y piden servicios con llamada.
+ *
+ */
+
+#ifndef _SIMULADOR_H
+#define _SIMULADOR_H
+
+/* Contadores del HAL simulado */
+typedef struct {
+	unsigned long ticks;		/* interrupciones de reloj */
+	unsigned long parado;		/* de ellas, con el procesador en halt */
+	unsigned long llamadas;		/* llamadas al sistema */
+	unsigned long ints_sw;		/* interrupciones software */
+	unsigned long cambios;		/* cambios de contexto */
+} contadores_sim;
+
+extern contadores_sim contadores;
+
+/* 1 para mostrar los mensajes del kernel (por defecto se descartan) */
+extern int salida_kernel;
+
+/*
+ * Arranca el kernel y lo ejecuta hasta que no queda ninguna imagen (fin
+ * normal del sistema) o se llega a limite ticks (0: sin limite).
+ * Devuelve 0 en el primer caso y 1 en el segundo.
+ */
+int simular(unsigned long limite);
+
+/* Consume ticks de procesador en modo usuario */
+void calcular(int ticks);
+
+/* Llamada al sistema desde un proceso simulado, como llamsis */
+long llamada(int nserv, int nargs, ...);
+
+/* Frecuencia de reloj fijada por el kernel (ticks/segundo) */
+int frecuencia_reloj();
+
+/*
+ * La define el programa de simulacion: funcion que ejecuta el programa
+ * de ese nombre (la que crear_imagen devuelve como punto de arranque),
+ * o NULL si no existe
+ */
+void * buscar_programa(char *nombre);
+
+#endif /* _SIMULADOR_H */
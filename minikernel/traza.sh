@@ -0,0 +1,31 @@
+## Genera include/traza.h a partir de la salida de una ejecucion grabada
+##
+## Uso:
+##	cd minikernel; make clean; make TRAZA=1	(kernel que graba)
+##	boot/boot minikernel/kernel > out.out
+##	sh minikernel/traza.sh out.out > minikernel/include/traza.h
+##	cd minikernel; make clean; make TRAZA=2	(kernel que reproduce)
+##
+## Cada evento grabado es una linea "#TRAZA tick pid llamadas activaciones
+## tipo dato"; puede aparecer pegada a la salida de los procesos.
+
+set -e
+
+echo "/*"
+echo " *  minikernel/include/traza.h"
+echo " *"
+echo " * Generado por traza.sh a partir de $1"
+echo " *"
+echo " */"
+echo
+echo "evento_traza traza_reproduccion[] = {"
+tr -d '\r' < "$1" | awk '
+{
+	i = index($0, "#TRAZA ");
+	if (i == 0)
+		next;
+	split(substr($0, i + 7), c, " ");
+	printf("\t{%s, %s, %s, %s, %s, %s},\n", c[1], c[2], c[3], c[4], c[5], c[6]);
+}'
+echo "	{0, 0, 0, 0, EV_FIN, 0}"
+echo "};"
@@ -21,8 +21,29 @@ rm -f usuario/simplon
 rm -f usuario/yosoy
 rm -f usuario/get_ppid
 rm -f usuario/espera
+rm -f usuario/productor
+rm -f usuario/consumidor
+rm -f usuario/top
+rm -f usuario/control
+rm -f usuario/alarmas
+rm -f usuario/supervisor
+rm -f usuario/memoria
+rm -f usuario/parametros
+rm -f usuario/carga
+rm -f usuario/barrido
+rm -f usuario/inanicion
+rm -f usuario/perfil
+rm -f usuario/holgura
+rm -f usuario/pingpong
+rm -f usuario/fases
+rm -f usuario/grupos
+rm -f usuario/llamadas
+rm -f usuario/reparto
+rm -f usuario/lotes
+rm -f usuario/tareas
 
 rm -f usuario/lib/serv.o
+rm -f usuario/lib/hilos.o
 rm -f usuario/lib/libserv.a
 
 
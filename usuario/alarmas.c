@@ -0,0 +1,42 @@
+/*
+ * usuario/alarmas.c
+ *
+ * Programa de usuario que calcula mientras un temporizador periodico
+ * y una alarma ejecutan sus manejadores de forma asincrona.
+ */
+
+#include "servicios.h"
+
+#define PERIODO 20	/* ticks entre avisos del temporizador */
+#define PLAZO 50	/* ticks hasta la alarma */
+#define TOT_AVISOS 5
+
+static volatile int avisos = 0;
+static volatile int alarma_vencida = 0;
+
+static void tic(){
+	avisos++;
+	printf("alarmas: aviso %d del temporizador\n", avisos);
+}
+
+static void despertador(){
+	alarma_vencida = 1;
+	printf("alarmas: vence la alarma\n");
+}
+
+int main(){
+	long vueltas = 0;
+
+	temporizador(PERIODO, tic);
+	alarma(PLAZO, despertador);	/* sustituye al temporizador */
+	while (!alarma_vencida)
+		vueltas++;
+	printf("alarmas: %ld vueltas de calculo hasta la alarma\n", vueltas);
+
+	temporizador(PERIODO, tic);
+	while (avisos < TOT_AVISOS)
+		vueltas++;
+	temporizador(0, 0);
+	printf("alarmas: termina tras %d avisos\n", avisos);
+	return 0;
+}
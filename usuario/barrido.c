@@ -0,0 +1,31 @@
+/*
+ * usuario/barrido.c
+ *
+ * Programa de usuario que lanza el generador de carga con distintos
+ * parametros, sin un ejecutable por cada variante.
+ */
+
+#include "servicios.h"
+
+#define TOT_VARIANTES 3
+
+static char *variantes[TOT_VARIANTES][4]={
+	{"carga", "1000000", "3", 0},
+	{"carga", "10000000", "2", 0},
+	{"carga", "100000", "2", "1"}};
+
+int main(){
+	int i, argc;
+
+	for (i=0; i<TOT_VARIANTES; i++){
+		for (argc=0; variantes[i][argc] != 0; argc++);
+		if (crear_proceso_args("carga", argc, variantes[i])<0)
+			printf("barrido: error creando la variante %d\n", i);
+	}
+	/* sin argumentos carga muestra su uso */
+	if (crear_proceso_args("carga", 0, 0)<0)
+		printf("barrido: error creando carga sin argumentos\n");
+	espera();
+	printf("barrido: termina\n");
+	return 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * usuario/carga.c
+ *
+ * Generador de carga parametrizable: "carga iteraciones repeticiones"
+ * repite un bucle de calculo como el de yosoy y duerme "segundos" entre
+ * repeticiones si se le pasa un tercer argumento.
+ */
+
+#include "servicios.h"
+
+/* convierte una cadena de digitos en entero */
+static long numero(char *cad){
+	long n = 0;
+
+	while (*cad >= '0' && *cad <= '9')
+		n = n * 10 + (*cad++ - '0');
+	return n;
+}
+
+int main(int argc, char *argv[]){
+	long iteraciones, j, k;
+	int repeticiones, segundos = 0, i;
+
+	if (argc < 3){
+		printf("uso: carga iteraciones repeticiones [segundos]\n");
+		return -1;
+	}
+	iteraciones = numero(argv[1]);
+	repeticiones = numero(argv[2]);
+	if (argc > 3)
+		segundos = numero(argv[3]);
+
+	for (i=0; i<repeticiones; i++){
+		k = 0;
+		for (j=0; j<iteraciones; j++)
+			k += 2*j;
+		printf("carga %d: repeticion %d de %ld iteraciones\n", get_pid(),
+			i, iteraciones);
+		if (segundos > 0)
+			dormir(segundos);
+	}
+	return 0;
+}
@@ -0,0 +1,26 @@
+/*
+ * usuario/consumidor.c
+ *
+ * Programa de usuario que lee de la tuberia heredada del productor
+ * (descriptor 0 de lectura y 1 de escritura) hasta fin de fichero y
+ * vuelca lo leido por pantalla.
+ */
+
+#include "servicios.h"
+
+#define TAM_BUF 20	/* menor que el mensaje: lecturas parciales */
+
+int main(){
+	char buf[TAM_BUF];
+	int leidos, total=0;
+
+	/* el consumidor solo lee */
+	cerrar_desc(1);
+
+	while ((leidos=leer_desc(0, buf, TAM_BUF))>0){
+		escribir(buf, leidos);
+		total+=leidos;
+	}
+	printf("consumidor: fin de fichero tras %d bytes\n", total);
+	return 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * usuario/control.c
+ *
+ * Programa de usuario que hace de tarea de control periodica de tiempo
+ * real (EDF): cada PERIODO ticks ejecuta un trabajo corto y espera al
+ * siguiente periodo. Al acabar muestra los plazos que ha perdido.
+ */
+
+#include "servicios.h"
+
+#define PERIODO 20	/* ticks */
+#define PRESUPUESTO 5	/* ticks de procesador por periodo */
+#define TOT_PERIODOS 20
+#define TRABAJO 1000000	/* iteraciones del calculo de cada periodo */
+
+int main(){
+	int i, j, k, perdidos = 0;
+
+	/* un conjunto que ocupa todo el procesador no se admite */
+	if (fijar_tiempo_real(PERIODO, PERIODO) == 0)
+		printf("control: admitida una utilizacion del 100%%\n");
+
+	if (fijar_tiempo_real(PERIODO, PRESUPUESTO)<0){
+		printf("control: tarea de tiempo real no admitida\n");
+		return -1;
+	}
+	for (i=0; i<TOT_PERIODOS; i++){
+		k=0;
+		for (j=0; j<TRABAJO; j++)
+			k+=2*j;
+		perdidos = esperar_periodo();
+	}
+	printf("control %d: %d periodos, %d plazos perdidos\n", get_pid(),
+		TOT_PERIODOS, perdidos);
+	return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * usuario/fases.c
+ *
+ * Programa de usuario con un coordinador y varios trabajadores que
+ * avanzan por fases sin volver a crearse: en cada fase cada trabajador
+ * se anota en el contador de la fase, protegido con un semaforo, y
+ * todos se esperan en una barrera antes de pasar a la siguiente. Los
+ * trabajadores ejecutan este mismo programa y se reconocen porque
+ * heredan la barrera ya creada.
+ */
+
+#include "servicios.h"
+
+#define TRABAJADORES 4
+#define FASES 3
+#define ITERACIONES 2000000	/* calculo de cada trabajador por fase */
+
+static int barrera, mutex;	/* ids, comunes a todas las instancias */
+static volatile int hechos[FASES];	/* trabajadores que acabaron cada fase */
+
+static void trabajar(){
+	long j, k = 0;
+	int fase;
+
+	for (fase=0; fase<FASES; fase++){
+		for (j=0; j<ITERACIONES; j++)
+			k += 2*j;
+		bajar_semaforo(mutex);
+		hechos[fase]++;
+		subir_semaforo(mutex);
+		esperar_barrera(barrera);
+	}
+}
+
+int main(){
+	int i, fase;
+
+	if ((barrera = abrir_semaforo("fases")) >= 0){
+		mutex = abrir_semaforo("fases_total");
+		trabajar();
+		return 0;
+	}
+	for (fase=0; fase<FASES; fase++)
+		hechos[fase] = 0;
+	barrera = crear_barrera("fases", TRABAJADORES + 1);
+	mutex = crear_semaforo("fases_total", 1);
+	if (barrera < 0 || mutex < 0){
+		printf("fases: error creando semaforos\n");
+		return -1;
+	}
+	for (i=0; i<TRABAJADORES; i++)
+		if (crear_proceso("fases") < 0)
+			printf("fases: error creando trabajador\n");
+	for (fase=0; fase<FASES; fase++){
+		if (esperar_barrera(barrera) == 1)
+			printf("fases: el coordinador cierra la fase %d\n", fase);
+		printf("fases: fase %d terminada por %d de %d trabajadores\n",
+			fase, hechos[fase], TRABAJADORES);
+	}
+	cerrar_semaforo(mutex);
+	cerrar_semaforo(barrera);
+	return 0;
+}
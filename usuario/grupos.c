@@ -0,0 +1,47 @@
+/*
+ * usuario/grupos.c
+ *
+ * Programa de usuario que lanza trabajos formados por varios procesos
+ * en su propio grupo. Al primero lo termina entero con matar_grupo
+ * mientras sus miembros calculan, duermen o esperan a sus hijos; al
+ * segundo lo deja acabar y lo recoge con esperar_grupo.
+ */
+
+#include "servicios.h"
+
+static char *largo[]={"carga", "60000000", "20"};
+static char *corto[]={"carga", "3000000", "2"};
+static char *dormilon[]={"carga", "1000", "20", "1"};
+
+/* crea un grupo con los procesos dados sin salir del grupo actual */
+static int lanzar(char **trabajo[], int argc[], int n){
+	int anterior = get_gid(), gid, i;
+
+	gid = crear_grupo();
+	for (i=0; i<n; i++)
+		if (crear_proceso_args("carga", argc[i], trabajo[i]) < 0)
+			printf("grupos: error creando carga\n");
+	fijar_grupo(anterior);
+	return gid;
+}
+
+int main(){
+	char **trabajo1[]={largo, largo, dormilon};
+	int argc1[]={3, 3, 4};
+	char **trabajo2[]={corto, corto};
+	int argc2[]={3, 3};
+	int gid;
+
+	gid = lanzar(trabajo1, argc1, 3);
+	printf("grupos: trabajo 1 en el grupo %d (yo en el %d)\n", gid, get_gid());
+	dormir(1);
+	printf("grupos: terminados %d procesos del grupo %d\n",
+		matar_grupo(gid), gid);
+	printf("grupos: esperar_grupo(%d) = %d\n", gid, esperar_grupo(gid));
+
+	gid = lanzar(trabajo2, argc2, 2);
+	printf("grupos: trabajo 2 en el grupo %d\n", gid);
+	esperar_grupo(gid);
+	printf("grupos: el trabajo 2 ha acabado\n");
+	return 0;
+}
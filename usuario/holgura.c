@@ -0,0 +1,39 @@
+/*
+ * usuario/holgura.c
+ *
+ * Programa de usuario que lanza varios procesos que calculan un poco y
+ * duermen, primero sin holgura y luego con ella, y compara cuantas
+ * pasadas de despertar ha necesitado el kernel en cada caso.
+ */
+
+#include "servicios.h"
+
+#define NUM_DORMILONES 4
+#define HOLGURA 30	/* ticks que se puede retrasar cada despertar */
+#define SEGUNDOS 8	/* segundos que tardan en acabar los dormilones */
+
+static char *dormilon[]={"carga", "5000000", "5", "1"};
+
+/* lanza los dormilones con la holgura dada y espera a que acaben */
+static void prueba(int holgura){
+	estadisticas antes, despues;
+	int i;
+
+	fijar_holgura(holgura);
+	estadisticas_sistema(&antes);
+	for (i=0; i<NUM_DORMILONES; i++)
+		if (crear_proceso_args("carga", 4, dormilon) < 0)
+			printf("holgura: error creando carga\n");
+	fijar_holgura(0);
+	dormir(SEGUNDOS);
+	estadisticas_sistema(&despues);
+	printf("holgura: con %d ticks %lu despertados en %lu pasadas\n",
+		holgura, despues.despertados - antes.despertados,
+		despues.pasadas_despertar - antes.pasadas_despertar);
+}
+
+int main(){
+	prueba(0);
+	prueba(HOLGURA);
+	return 0;
+}
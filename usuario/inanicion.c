@@ -0,0 +1,48 @@
+/*
+ * usuario/inanicion.c
+ *
+ * Programa de usuario que lanza procesos de calculo junto a uno que
+ * duerme a menudo y muestra la espera en la cola de listos de cada
+ * proceso: veces que ha ejecutado, espera media y maxima en ticks y
+ * veces que el kernel le ha adelantado por envejecimiento.
+ */
+
+#include "servicios.h"
+
+#define NUM_CALCULO 3	/* procesos que no dejan el procesador */
+#define TOT_INFORMES 3	/* veces que se muestra la tabla */
+#define PERIODO 1	/* segundos entre informes */
+#define MAX_FILAS 10	/* tantas como entradas de la tabla de procesos */
+
+static char *calculo[]={"carga", "60000000", "6"};
+static char *interactivo[]={"carga", "200000", "8", "1"};
+
+static void informe(){
+	info_espera info[MAX_FILAS];
+	int i, n;
+
+	n = esperas_listos(info, MAX_FILAS);
+	printf("inanicion: proceso estado veces media maxima envejecido\n");
+	for (i=0; i<n; i++)
+		printf("inanicion: %d %d %lu %lu %lu %lu\n", info[i].id,
+			info[i].estado, info[i].veces, info[i].media,
+			info[i].maxima, info[i].envejecimientos);
+}
+
+int main(){
+	int i;
+
+	printf("inanicion: umbral de envejecimiento %d ticks\n",
+		leer_parametro(PARAM_ENVEJECIMIENTO));
+	for (i=0; i<NUM_CALCULO; i++)
+		if (crear_proceso_args("carga", 3, calculo) < 0)
+			printf("inanicion: error creando carga\n");
+	if (crear_proceso_args("carga", 4, interactivo) < 0)
+		printf("inanicion: error creando carga\n");
+
+	for (i=0; i<TOT_INFORMES; i++){
+		dormir(PERIODO);
+		informe();
+	}
+	return 0;
+}
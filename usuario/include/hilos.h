@@ -0,0 +1,43 @@
+/*
+ *  usuario/include/hilos.h
+ *
+ * Biblioteca de hilos de usuario (usuario/lib/hilos.c): muchos hilos
+ * cooperativos dentro de un solo proceso del minikernel, cada uno con
+ * su pila de TAM_PILA_HILO bytes. Un hilo solo deja el procesador a
+ * otro del mismo proceso al llamar a hilo_ceder, al terminar o en las
+ * llamadas bloqueantes de la biblioteca, que bloquean al hilo y no al
+ * proceso mientras queden otros hilos listos.
+ *
+ * El hilo 0 es el que ejecuta main. Si main termina, el proceso termina
+ * con todos sus hilos. hilo_dormir usa la alarma del proceso, asi que
+ * no se puede mezclar con alarma ni temporizador. Las instancias de un
+ * mismo programa que ejecutan a la vez comparten la imagen y con ella
+ * los hilos: solo una de ellas debe usarlos.
+ */
+
+#ifndef HILOS_H
+#define HILOS_H
+
+#define MAX_HILOS 256		/* incluido el hilo 0 */
+#define TAM_PILA_HILO 16384
+
+/* Crea un hilo listo que ejecuta funcion(arg). Devuelve su id o -1 */
+int hilo_crear(void (*funcion)(void *), void *arg);
+
+/* Termina el hilo que llama; terminar el hilo 0 termina el proceso */
+void hilo_salir();
+
+/* Id del hilo que llama */
+int hilo_id();
+
+/* Pasa al siguiente hilo listo, si lo hay */
+void hilo_ceder();
+
+/* Espera a que termine el hilo id y libera su entrada. -1 si no existe */
+int hilo_esperar(int id);
+
+/* Como dormir y leer_caracter, pero solo bloquean al hilo */
+int hilo_dormir(int segundos);
+int hilo_leer_caracter();
+
+#endif /* HILOS_H */
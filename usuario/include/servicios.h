@@ -19,6 +19,8 @@
 #ifndef SERVICIOS_H
 #define SERVICIOS_H
 
+#include "llamsis.h"	/* estructuras estadisticas e info_memoria */
+
 /* Evita el uso del printf de la bilioteca estndar */
 #define printf escribirf
 
@@ -33,5 +35,51 @@ int get_pid();
 int dormir(int tiempo);
 int get_ppid();
 int espera();
+int crear_tuberia(int desc[2]);
+int leer_desc(int desc, char *buf, int longi);
+int escribir_desc(int desc, char *buf, int longi);
+int cerrar_desc(int desc);
+int estadisticas_sistema(estadisticas *est);
+int fijar_tiempo_real(int periodo, int presupuesto);
+int esperar_periodo();
+int alarma(int ticks, void (*manejador)());
+int temporizador(int periodo, void (*manejador)());
+int esperar_eventos(int conjunto, int timeout);
+int leer_caracter();
+int crear_proceso_ext(char *prog, int tam_pila);
+int memoria_sistema(info_memoria *mem);
+int leer_parametro(int n);
+int fijar_parametro(int n, int valor);
+int crear_proceso_args(char *prog, int argc, char *argv[]);
+int argumentos(char ***argv);
+int esperas_listos(info_espera *info, int max);
+int iniciar_perfil(int modo);
+int leer_perfil(info_perfil *perfil);
+int fijar_holgura(int ticks);
+int ceder();
+int ceder_a(int pid);
+int crear_semaforo(char *nombre, int valor);
+int crear_barrera(char *nombre, int partes);
+int abrir_semaforo(char *nombre);
+int cerrar_semaforo(int id);
+int bajar_semaforo(int id);
+int subir_semaforo(int id);
+int esperar_barrera(int id);
+int crear_grupo();
+int fijar_grupo(int gid);
+int get_gid();
+int matar_grupo(int gid);
+int esperar_grupo(int gid);
+int trazar(int pid, unsigned long mascara);
+int leer_traza(int pid, info_llamada *llamadas, int max);
+int fijar_reparto(int gid, int peso, int cuota);
+int leer_reparto(int gid, info_reparto *info);
+int procesar_lote(anillo_lote *anillo);
+
+/* Manejo del anillo de peticiones por lotes desde el proceso */
+void iniciar_lote(anillo_lote *anillo);
+int encolar_peticion(anillo_lote *anillo, long dato, int servicio,
+	int nargs, ...);
+int recoger_fin(anillo_lote *anillo, long *dato, long *resultado);
 
 #endif /* SERVICIOS_H */
@@ -0,0 +1,282 @@
+/*
+ *  usuario/lib/hilos.c
+ *
+ * Hilos cooperativos de usuario (ver hilos.h). Cada hilo guarda su
+ * contexto en un ucontext_t y ejecuta en una pila de la reserva
+ * estatica; el que ejecuta no esta en ninguna lista, los listos forman
+ * una cola FIFO y los bloqueados esperan en la lista de su causa.
+ *
+ * Cuando no queda ningun hilo listo el proceso se bloquea en el kernel
+ * con esperar_eventos hasta el primer despertar o hasta que haya
+ * caracteres. Mientras hay hilos listos, la alarma del proceso avisa de
+ * que ha vencido un plazo y la siguiente conmutacion despierta a los
+ * hilos que toque, de modo que hilo_ceder no entra al kernel.
+ *
+ */
+
+#include <ucontext.h>
+
+#include "servicios.h"
+#include "hilos.h"
+
+/* Estados de un hilo */
+#define LIBRE 0
+#define LISTO 1		/* incluye al que ejecuta */
+#define BLOQUEADO 2
+#define TERMINADO 3	/* hasta que lo recoge hilo_esperar */
+
+/* Ticks entre consultas del teclado si hay hilos esperandolo */
+#define SONDEO_TECLADO 10
+
+typedef struct hilo_t *hilo_ptr;
+
+typedef struct hilo_t {
+	int estado;
+	ucontext_t contexto;
+	void (*funcion)(void *);
+	void *arg;
+	unsigned long despertar;	/* tick en que acaba hilo_dormir */
+	hilo_ptr esperando;		/* hilo bloqueado en hilo_esperar */
+	hilo_ptr siguiente;
+} hilo;
+
+typedef struct {
+	hilo *primero;
+	hilo *ultimo;
+} lista_hilos;
+
+static hilo tabla_hilos[MAX_HILOS];
+static char pilas[MAX_HILOS-1][TAM_PILA_HILO];	/* el hilo 0 usa la del proceso */
+
+static hilo *actual = 0;		/* 0 hasta el primer hilo_crear */
+static lista_hilos listos, dormidos, teclado;
+static volatile int alarma_vencida;
+static int alarma_puesta;
+
+/*
+ *
+ * Listas de hilos, como las listas de BCPs del kernel
+ *
+ */
+
+static void insertar_ultimo(lista_hilos *lista, hilo *h){
+	if (lista->primero==0)
+		lista->primero = h;
+	else
+		lista->ultimo->siguiente = h;
+	lista->ultimo = h;
+	h->siguiente = 0;
+}
+
+/* inserta por orden de despertar, detras de los que vencen a la vez */
+static void insertar_ordenado(lista_hilos *lista, hilo *h){
+	hilo *ant = 0, *paux = lista->primero;
+
+	for ( ; paux && paux->despertar <= h->despertar; paux = paux->siguiente)
+		ant = paux;
+	h->siguiente = paux;
+	if (ant)
+		ant->siguiente = h;
+	else
+		lista->primero = h;
+	if (paux==0)
+		lista->ultimo = h;
+}
+
+static hilo *eliminar_primero(lista_hilos *lista){
+	hilo *h = lista->primero;
+
+	if (lista->ultimo==lista->primero)
+		lista->ultimo = 0;
+	lista->primero = h->siguiente;
+	return h;
+}
+
+/*
+ *
+ * Planificacion
+ *
+ */
+
+static void despertador(){
+	alarma_vencida = 1;
+}
+
+static unsigned long ticks_actuales(){
+	estadisticas est;
+
+	estadisticas_sistema(&est);
+	return est.ticks;
+}
+
+/*
+ * Programa la alarma del proceso para el primer despertar pendiente o,
+ * si hay hilos esperando al teclado, para la siguiente consulta
+ */
+static void programar_alarma(unsigned long ahora){
+	int plazo = 0;
+
+	if (dormidos.primero)
+		plazo = dormidos.primero->despertar > ahora ?
+			dormidos.primero->despertar - ahora : 1;
+	if (teclado.primero && (plazo == 0 || plazo > SONDEO_TECLADO))
+		plazo = SONDEO_TECLADO;
+	if (plazo == 0 && !alarma_puesta)
+		return;
+	alarma(plazo, despertador);
+	alarma_puesta = plazo > 0;
+}
+
+static void poner_listo(hilo *h){
+	h->estado = LISTO;
+	insertar_ultimo(&listos, h);
+}
+
+/*
+ * Pasa a listos los hilos cuya espera ha acabado. Con bloquear, si no
+ * queda ninguno listo bloquea al proceso hasta que lo haya.
+ */
+static void atender_esperas(int bloquear){
+	unsigned long ahora;
+	int plazo;
+
+	for (;;){
+		ahora = ticks_actuales();
+		while (dormidos.primero && dormidos.primero->despertar <= ahora)
+			poner_listo(eliminar_primero(&dormidos));
+		if (teclado.primero &&
+		    (esperar_eventos(EVENTO_TECLADO, 0) & EVENTO_TECLADO))
+			while (teclado.primero)
+				poner_listo(eliminar_primero(&teclado));
+		if (!bloquear || listos.primero)
+			break;
+		if (dormidos.primero == 0 && teclado.primero == 0){
+			printf("hilos: todos los hilos estan bloqueados\n");
+			terminar_proceso();
+		}
+		plazo = dormidos.primero ?
+			(int)(dormidos.primero->despertar - ahora) : -1;
+		esperar_eventos(teclado.primero ? EVENTO_TECLADO : 0, plazo);
+	}
+	programar_alarma(ahora);
+}
+
+/*
+ * Cede el procesador al primer hilo listo. El que llama ya debe estar
+ * en la lista que le corresponda.
+ */
+static void cambiar_hilo(){
+	hilo *anterior = actual;
+
+	if (alarma_vencida){
+		alarma_vencida = 0;
+		atender_esperas(0);
+	}
+	if (listos.primero == 0)
+		atender_esperas(1);
+	actual = eliminar_primero(&listos);
+	if (actual != anterior)
+		swapcontext(&anterior->contexto, &actual->contexto);
+}
+
+/* Todo hilo creado empieza aqui */
+static void arranque(){
+	actual->funcion(actual->arg);
+	hilo_salir();
+}
+
+/*
+ *
+ * Funciones de la biblioteca
+ *
+ */
+
+int hilo_crear(void (*funcion)(void *), void *arg){
+	hilo *h;
+	int id;
+
+	if (actual == 0){		/* el primero: main pasa a ser el hilo 0 */
+		actual = &tabla_hilos[0];
+		actual->estado = LISTO;
+	}
+	for (id=1; id<MAX_HILOS && tabla_hilos[id].estado!=LIBRE; id++);
+	if (id == MAX_HILOS)
+		return -1;
+	h = &tabla_hilos[id];
+	h->funcion = funcion;
+	h->arg = arg;
+	h->esperando = 0;
+	getcontext(&h->contexto);
+	h->contexto.uc_stack.ss_sp = pilas[id-1];
+	h->contexto.uc_stack.ss_size = TAM_PILA_HILO;
+	h->contexto.uc_link = 0;
+	makecontext(&h->contexto, arranque, 0);
+	poner_listo(h);
+	return id;
+}
+
+void hilo_salir(){
+	if (actual == 0 || actual == &tabla_hilos[0])
+		terminar_proceso();
+	/* su pila no se reutiliza hasta que otro hilo lo recoja */
+	actual->estado = TERMINADO;
+	if (actual->esperando)
+		poner_listo(actual->esperando);
+	cambiar_hilo();
+}
+
+int hilo_id(){
+	return actual ? actual - tabla_hilos : 0;
+}
+
+void hilo_ceder(){
+	if (actual == 0 || (listos.primero == 0 && !alarma_vencida))
+		return;
+	insertar_ultimo(&listos, actual);
+	cambiar_hilo();
+}
+
+int hilo_esperar(int id){
+	hilo *h;
+
+	if (actual == 0 || id <= 0 || id >= MAX_HILOS)
+		return -1;
+	h = &tabla_hilos[id];
+	if (h == actual || h->estado == LIBRE ||
+	    (h->esperando && h->esperando != actual))
+		return -1;
+	while (h->estado != TERMINADO){
+		h->esperando = actual;
+		actual->estado = BLOQUEADO;
+		cambiar_hilo();
+	}
+	h->esperando = 0;
+	h->estado = LIBRE;
+	return 0;
+}
+
+int hilo_dormir(int segundos){
+	unsigned long ahora;
+
+	if (actual == 0)
+		return dormir(segundos);
+	ahora = ticks_actuales();
+	actual->despertar = ahora + segundos * leer_parametro(PARAM_TICK);
+	actual->estado = BLOQUEADO;
+	insertar_ordenado(&dormidos, actual);
+	programar_alarma(ahora);
+	cambiar_hilo();
+	return 0;
+}
+
+int hilo_leer_caracter(){
+	if (actual == 0)
+		return leer_caracter();
+	while (!(esperar_eventos(EVENTO_TECLADO, 0) & EVENTO_TECLADO)){
+		actual->estado = BLOQUEADO;
+		insertar_ultimo(&teclado, actual);
+		programar_alarma(ticks_actuales());
+		cambiar_hilo();
+	}
+	return leer_caracter();
+}
@@ -16,6 +16,8 @@
  *
  */
 
+#include <stdarg.h>
+
 #include "llamsis.h"
 #include "servicios.h"
 
@@ -54,4 +56,189 @@ int get_ppid() {
 }
 int espera(){
 	return llamsis(ESPERA, 0);
+}
+int crear_tuberia(int desc[2]){
+	return llamsis(CREAR_TUBERIA, 1, (long)desc);
+}
+int leer_desc(int desc, char *buf, int longi){
+	return llamsis(LEER_DESC, 3, (long)desc, (long)buf, (long)longi);
+}
+int escribir_desc(int desc, char *buf, int longi){
+	return llamsis(ESCRIBIR_DESC, 3, (long)desc, (long)buf, (long)longi);
+}
+int cerrar_desc(int desc){
+	return llamsis(CERRAR_DESC, 1, (long)desc);
+}
+int estadisticas_sistema(estadisticas *est){
+	return llamsis(ESTADISTICAS_SISTEMA, 1, (long)est);
+}
+int fijar_tiempo_real(int periodo, int presupuesto){
+	return llamsis(FIJAR_TIEMPO_REAL, 2, (long)periodo, (long)presupuesto);
+}
+int esperar_periodo(){
+	return llamsis(ESPERAR_PERIODO, 0);
+}
+int alarma(int ticks, void (*manejador)()){
+	return llamsis(ALARMA, 2, (long)ticks, (long)manejador);
+}
+int temporizador(int periodo, void (*manejador)()){
+	return llamsis(TEMPORIZADOR, 2, (long)periodo, (long)manejador);
+}
+int esperar_eventos(int conjunto, int timeout){
+	return llamsis(ESPERAR_EVENTOS, 2, (long)conjunto, (long)timeout);
+}
+int leer_caracter(){
+	return llamsis(LEER_CARACTER, 0);
+}
+int crear_proceso_ext(char *prog, int tam_pila){
+	return llamsis(CREAR_PROCESO_EXT, 2, (long)prog, (long)tam_pila);
+}
+int memoria_sistema(info_memoria *mem){
+	return llamsis(MEMORIA_SISTEMA, 1, (long)mem);
+}
+int leer_parametro(int n){
+	return llamsis(LEER_PARAMETRO, 1, (long)n);
+}
+int fijar_parametro(int n, int valor){
+	return llamsis(FIJAR_PARAMETRO, 2, (long)n, (long)valor);
+}
+int crear_proceso_args(char *prog, int argc, char *argv[]){
+	return llamsis(CREAR_PROCESO_ARGS, 3, (long)prog, (long)argc,
+		(long)argv);
+}
+int argumentos(char ***argv){
+	return llamsis(ARGUMENTOS, 1, (long)argv);
+}
+int esperas_listos(info_espera *info, int max){
+	return llamsis(ESPERAS_LISTOS, 2, (long)info, (long)max);
+}
+int iniciar_perfil(int modo){
+	return llamsis(INICIAR_PERFIL, 1, (long)modo);
+}
+int leer_perfil(info_perfil *perfil){
+	return llamsis(LEER_PERFIL, 1, (long)perfil);
+}
+int fijar_holgura(int ticks){
+	return llamsis(FIJAR_HOLGURA, 1, (long)ticks);
+}
+int ceder(){
+	return llamsis(CEDER, 0);
+}
+int ceder_a(int pid){
+	return llamsis(CEDER_A, 1, (long)pid);
+}
+int crear_semaforo(char *nombre, int valor){
+	return llamsis(CREAR_SEMAFORO, 2, (long)nombre, (long)valor);
+}
+int crear_barrera(char *nombre, int partes){
+	return llamsis(CREAR_BARRERA, 2, (long)nombre, (long)partes);
+}
+int abrir_semaforo(char *nombre){
+	return llamsis(ABRIR_SEMAFORO, 1, (long)nombre);
+}
+int cerrar_semaforo(int id){
+	return llamsis(CERRAR_SEMAFORO, 1, (long)id);
+}
+int bajar_semaforo(int id){
+	return llamsis(BAJAR_SEMAFORO, 1, (long)id);
+}
+int subir_semaforo(int id){
+	return llamsis(SUBIR_SEMAFORO, 1, (long)id);
+}
+int esperar_barrera(int id){
+	return llamsis(ESPERAR_BARRERA, 1, (long)id);
+}
+int crear_grupo(){
+	return llamsis(CREAR_GRUPO, 0);
+}
+int fijar_grupo(int gid){
+	return llamsis(FIJAR_GRUPO, 1, (long)gid);
+}
+int get_gid(){
+	return llamsis(GET_GID, 0);
+}
+int matar_grupo(int gid){
+	return llamsis(MATAR_GRUPO, 1, (long)gid);
+}
+int esperar_grupo(int gid){
+	return llamsis(ESPERAR_GRUPO, 1, (long)gid);
+}
+int trazar(int pid, unsigned long mascara){
+	return llamsis(TRAZAR, 2, (long)pid, (long)mascara);
+}
+int leer_traza(int pid, info_llamada *llamadas, int max){
+	return llamsis(LEER_TRAZA, 3, (long)pid, (long)llamadas, (long)max);
+}
+int fijar_reparto(int gid, int peso, int cuota){
+	return llamsis(FIJAR_REPARTO, 3, (long)gid, (long)peso, (long)cuota);
+}
+int leer_reparto(int gid, info_reparto *info){
+	return llamsis(LEER_REPARTO, 2, (long)gid, (long)info);
+}
+int procesar_lote(anillo_lote *anillo){
+	return llamsis(PROCESAR_LOTE, 1, (long)anillo);
+}
+
+/*
+ *
+ * Manejo del anillo de peticiones por lotes: se encolan llamadas sin
+ * entrar al kernel y se ejecutan todas con un solo procesar_lote
+ *
+ */
+
+void iniciar_lote(anillo_lote *anillo){
+	anillo->envio_cabeza = anillo->envio_cola = 0;
+	anillo->fin_cabeza = anillo->fin_cola = 0;
+}
+
+/* encola una llamada con hasta NUM_ARGS_LOTE argumentos; -1 si esta lleno */
+int encolar_peticion(anillo_lote *anillo, long dato, int servicio,
+	int nargs, ...){
+	peticion_lote *pet;
+	va_list args;
+	int i;
+
+	if (anillo->envio_cola - anillo->envio_cabeza == TAM_ANILLO_LOTE ||
+	    nargs > NUM_ARGS_LOTE)
+		return -1;
+	pet = &anillo->envios[anillo->envio_cola % TAM_ANILLO_LOTE];
+	pet->servicio = servicio;
+	pet->dato = dato;
+	va_start(args, nargs);
+	for (i=0; i<nargs; i++)
+		pet->args[i] = va_arg(args, long);
+	va_end(args);
+	anillo->envio_cola++;
+	return 0;
+}
+
+/* saca el resultado mas antiguo; 0 si no queda ninguno */
+int recoger_fin(anillo_lote *anillo, long *dato, long *resultado){
+	fin_lote *fin;
+
+	if (anillo->fin_cabeza == anillo->fin_cola)
+		return 0;
+	fin = &anillo->fines[anillo->fin_cabeza % TAM_ANILLO_LOTE];
+	*dato = fin->dato;
+	*resultado = fin->resultado;
+	anillo->fin_cabeza++;
+	return 1;
+}
+
+/*
+ *
+ * Punto de arranque de los procesos creados con crear_proceso_args: el
+ * kernel lo busca en la imagen y lo usa en vez de main para pasarle los
+ * argumentos que copio en la pila
+ *
+ */
+
+int main(int argc, char *argv[]);
+
+void arranque_args(){
+	char **argv;
+	int argc;
+
+	argc=argumentos(&argv);
+	main(argc, argv);
 }
\ No newline at end of file
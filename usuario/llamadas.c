@@ -0,0 +1,85 @@
+/*
+ * usuario/llamadas.c
+ *
+ * Programa de usuario que sigue las llamadas al sistema de otro
+ * proceso, como strace. Se lanza a si mismo como hijo (las instancias
+ * comparten variables globales), lo traza en cuanto publica su pid y
+ * va sacando del anillo lo anotado mientras el hijo duerme, consulta
+ * parametros y hace una rafaga de llamadas que desborda el anillo. Lo
+ * que quede sin leer al acabar lo vuelca el kernel como "#LLAMADA".
+ */
+
+#include "servicios.h"
+
+#define MAX_LEIDAS 8
+#define TAM_RAFAGA 32	/* lo que cabe en el anillo del kernel */
+
+static char *nombres[NSERVICIOS]={
+	"crear_proceso", "terminar_proceso", "escribir", "get_pid", "dormir",
+	"get_ppid", "espera", "crear_tuberia", "leer_desc", "escribir_desc",
+	"cerrar_desc", "estadisticas_sistema", "fijar_tiempo_real",
+	"esperar_periodo", "alarma", "temporizador", "esperar_eventos",
+	"leer_caracter", "crear_proceso_ext", "memoria_sistema",
+	"leer_parametro", "fijar_parametro", "crear_proceso_args",
+	"argumentos", "esperas_listos", "iniciar_perfil", "leer_perfil",
+	"fijar_holgura", "ceder", "ceder_a", "crear_semaforo",
+	"crear_barrera", "abrir_semaforo", "cerrar_semaforo",
+	"bajar_semaforo", "subir_semaforo", "esperar_barrera",
+	"crear_grupo", "fijar_grupo", "get_gid", "matar_grupo",
+	"esperar_grupo", "trazar", "leer_traza", "fijar_reparto",
+	"leer_reparto", "procesar_lote"};
+
+static volatile int lanzado = 0;
+static volatile int hijo = -1;
+static volatile int trazado = 0;
+
+static void trazado_por_el_padre(){
+	int i;
+
+	hijo = get_pid();
+	while (!trazado)
+		ceder();
+	dormir(1);
+	fijar_holgura(leer_parametro(PARAM_RODAJA));
+	dormir(1);
+	for (i=0; i<2*TAM_RAFAGA; i++)
+		get_ppid();
+}
+
+int main(){
+	info_llamada leidas[MAX_LEIDAS];
+	unsigned long siguiente = 0;
+	int n, i;
+
+	if (lanzado){
+		trazado_por_el_padre();
+		return 0;
+	}
+	lanzado = 1;
+	if (crear_proceso("llamadas") < 0){
+		printf("llamadas: error creando el hijo\n");
+		return 1;
+	}
+	while (hijo < 0)
+		ceder();
+	if (trazar(hijo, TODAS_LLAMADAS & ~LLAMADA(CEDER)) < 0){
+		printf("llamadas: no se pudo trazar a %d\n", hijo);
+		return 1;
+	}
+	trazado = 1;
+	while ((n = leer_traza(hijo, leidas, MAX_LEIDAS)) >= 0){
+		for (i=0; i<n; i++){
+			if (leidas[i].num != siguiente)
+				printf("llamadas: %lu perdidas\n",
+					leidas[i].num - siguiente);
+			siguiente = leidas[i].num + 1;
+			printf("llamadas: %d %s(%lx, %lx) = %ld [%lu-%lu]\n", hijo,
+				nombres[leidas[i].servicio], leidas[i].args[0],
+				leidas[i].args[1], leidas[i].resultado,
+				leidas[i].entrada, leidas[i].salida);
+		}
+		dormir(1);
+	}
+	printf("llamadas: %d ha terminado\n", hijo);
+	return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * usuario/lotes.c
+ *
+ * Programa de usuario que hace las mismas llamadas get_pid una a una y
+ * por lotes de TAM_ANILLO_LOTE con procesar_lote, comparando ticks y
+ * entradas al kernel. Despues escribe unas lineas con un solo lote y
+ * recoge el resultado de cada una por su dato.
+ */
+
+#include "servicios.h"
+
+#define VECES 200000
+
+static anillo_lote anillo;
+static char *lineas[]={"lotes: primera linea del lote\n",
+	"lotes: segunda linea del lote\n", "lotes: tercera linea del lote\n"};
+
+static int longitud(char *s){
+	int n = 0;
+
+	while (s[n])
+		n++;
+	return n;
+}
+
+static void medir(char *caso, int por_lotes){
+	estadisticas antes, despues;
+	long dato, res;
+	int i, n, pid = get_pid();
+
+	estadisticas_sistema(&antes);
+	for (i=0; i<VECES; i+=n){
+		if (!por_lotes){
+			n = 1;
+			if (get_pid() != pid)
+				printf("lotes: get_pid erroneo\n");
+			continue;
+		}
+		for (n=0; n<TAM_ANILLO_LOTE && i+n<VECES; n++)
+			encolar_peticion(&anillo, i+n, GET_PID, 0);
+		procesar_lote(&anillo);
+		while (recoger_fin(&anillo, &dato, &res))
+			if (res != pid)
+				printf("lotes: get_pid %ld erroneo\n", dato);
+	}
+	estadisticas_sistema(&despues);
+	printf("lotes: %s: %d get_pid en %lu ticks con %lu entradas al kernel\n",
+		caso, VECES, despues.ticks - antes.ticks,
+		despues.interrupciones[VECTOR_LLAMSIS] -
+		antes.interrupciones[VECTOR_LLAMSIS]);
+}
+
+int main(){
+	long dato, res;
+	int i, n;
+
+	iniciar_lote(&anillo);
+	medir("una a una", 0);
+	medir("por lotes", 1);
+
+	for (i=0; i<3; i++)
+		encolar_peticion(&anillo, i, ESCRIBIR, 2, (long)lineas[i],
+			(long)longitud(lineas[i]));
+	n = procesar_lote(&anillo);
+	printf("lotes: %d peticiones de escribir ejecutadas\n", n);
+	while (recoger_fin(&anillo, &dato, &res))
+		printf("lotes: escribir %ld devolvio %ld\n", dato, res);
+	return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * usuario/memoria.c
+ *
+ * Programa de usuario que arranca varios procesos pequenos con la
+ * pila minima y muestra la memoria del sistema antes y despues.
+ */
+
+#include "servicios.h"
+
+#define TOT_TRABAJADORES 6
+#define PILA_PEQUENA 8192	/* TAM_PILA_MIN */
+
+static void muestra(char *cuando){
+	info_memoria mem;
+	info_cache *c;
+	int i;
+
+	if (memoria_sistema(&mem)<0){
+		printf("memoria: error leyendo la memoria del sistema\n");
+		return;
+	}
+	printf("memoria (%s): %d procesos, pilas %ld (propia %ld, reserva %ld), "
+		"tabla %ld, arena %ld/%ld, objetos %ld\n", cuando, mem.procesos,
+		mem.pilas, mem.proceso, mem.reserva, mem.tabla_procesos,
+		mem.arena_usada, mem.arena, mem.objetos);
+	for (i=0; i<mem.num_caches; i++){
+		c = &mem.caches[i];
+		printf("memoria:   cache %s: tam %d, slabs %d, en uso %d, max %d, "
+			"asignaciones %d, fallos %d\n", c->nombre, c->tam_obj,
+			c->slabs, c->en_uso, c->max_en_uso, c->asignaciones,
+			c->fallos);
+	}
+}
+
+int main(){
+	int i;
+
+	muestra("inicio");
+	for (i=0; i<TOT_TRABAJADORES; i++)
+		if (crear_proceso_ext("get_pid", PILA_PEQUENA)<0)
+			printf("memoria: error creando get_pid\n");
+	if (crear_proceso_ext("get_pid", 100)==0)
+		printf("memoria: admitida una pila demasiado pequena\n");
+	muestra("con los trabajadores");
+	espera();
+	muestra("final");
+	return 0;
+}
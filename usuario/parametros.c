@@ -0,0 +1,42 @@
+/*
+ * usuario/parametros.c
+ *
+ * Programa de usuario que muestra los parametros del kernel y cambia
+ * en marcha la rodaja y la frecuencia del reloj.
+ */
+
+#include "servicios.h"
+
+static char *nombres[NUM_PARAMETROS]={"tick", "rodaja", "vueltas_max",
+	"castigo", "envejecimiento", "periodo_reparto"};
+
+/* ticks de reloj que dura un dormir(1) */
+static unsigned long ticks_por_segundo(){
+	estadisticas est;
+	unsigned long antes;
+
+	estadisticas_sistema(&est);
+	antes = est.ticks;
+	dormir(1);
+	estadisticas_sistema(&est);
+	return est.ticks - antes;
+}
+
+int main(){
+	int i;
+
+	for (i=0; i<NUM_PARAMETROS; i++)
+		printf("parametros: %s = %d\n", nombres[i], leer_parametro(i));
+	printf("parametros: dormir(1) dura %lu ticks\n", ticks_por_segundo());
+
+	if (fijar_parametro(PARAM_RODAJA, 0) == 0)
+		printf("parametros: admitida una rodaja nula\n");
+	if (fijar_parametro(PARAM_TICK, 55) == 0)
+		printf("parametros: admitido un tick que no es multiplo de 10\n");
+	fijar_parametro(PARAM_RODAJA, 2);
+	fijar_parametro(PARAM_TICK, 50);
+	printf("parametros: ahora rodaja = %d y tick = %d\n",
+		leer_parametro(PARAM_RODAJA), leer_parametro(PARAM_TICK));
+	printf("parametros: dormir(1) dura %lu ticks\n", ticks_por_segundo());
+	return 0;
+}
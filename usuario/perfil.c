@@ -0,0 +1,51 @@
+/*
+ * usuario/perfil.c
+ *
+ * Programa de usuario que perfila a yosoy y a si mismo. El kernel
+ * vuelca el perfil de cada proceso al terminar; minikernel/perfil.sh
+ * lo convierte en un perfil plano por funcion.
+ */
+
+#include "servicios.h"
+
+#define VUELTAS 30000000	/* iteraciones de cada bucle de calculo */
+
+/* dos funciones con distinto coste para que se vean en el perfil */
+static long suma(long n){
+	long i, k = 0;
+
+	for (i=0; i<n; i++)
+		k += 2*i;
+	return k;
+}
+
+static long suma_doble(long n){
+	return suma(n) + suma(n);
+}
+
+int main(){
+	info_perfil perfil;
+	int i, max = 0;
+
+	if (iniciar_perfil(PERFIL_PROCESO | PERFIL_HIJOS) < 0){
+		printf("perfil: no se puede perfilar\n");
+		return -1;
+	}
+	if (crear_proceso("yosoy") < 0)
+		printf("perfil: error creando yosoy\n");
+
+	suma(VUELTAS);
+	suma_doble(VUELTAS);
+
+	leer_perfil(&perfil);
+	for (i=1; i<NUM_CUBETAS_PERFIL; i++)
+		if (perfil.cubetas[i] > perfil.cubetas[max])
+			max = i;
+	printf("perfil: %lu muestras, %lu en el kernel, %lu fuera de la imagen\n",
+		perfil.muestras, perfil.en_kernel, perfil.fuera);
+	printf("perfil: cubeta mas usada %lx-%lx con %u muestras\n",
+		perfil.inicio + ((unsigned long)max << perfil.desplazamiento),
+		perfil.inicio + ((unsigned long)(max + 1) << perfil.desplazamiento),
+		perfil.cubetas[max]);
+	return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * usuario/pingpong.c
+ *
+ * Programa de usuario en el que dos procesos se pasan el turno a traves
+ * de variables globales, que comparten al ejecutar el mismo programa,
+ * junto a un proceso de calculo. Primero cada uno cede el procesador
+ * directamente al otro con ceder_a y luego solo con ceder, que tiene
+ * que dar la vuelta a la cola de listos. Al final vuelven a usar ceder_a
+ * mientras una tercera instancia hace de tarea EDF, que no debe perder
+ * plazos ni esperar a que acaben las cesiones.
+ */
+
+#include "servicios.h"
+
+#define INTERCAMBIOS 20	/* turnos de cada fase */
+
+#define PERIODO_TR 10	/* ticks del periodo de la tarea EDF */
+#define PRESUPUESTO_TR 3
+#define PERIODOS_TR 20
+
+static char *hijo[]={"pingpong", "hijo"};
+static char *tarea_tr[]={"pingpong", "tiempo_real"};
+static char *calculo[]={"carga", "60000000", "2"};
+
+static volatile int turno;	/* 0: le toca al padre, 1: al hijo */
+static volatile int pids[2] = {-1, -1};
+static volatile int directo;	/* 1 mientras se usa ceder_a */
+static volatile int seguir;	/* lo fija el padre en su turno */
+static volatile int tr_activa;	/* 1 mientras ejecuta la tarea EDF */
+
+/* espera su turno cediendo el procesador al otro */
+static void esperar_turno(int yo){
+	while (turno != yo){
+		if (directo && pids[1-yo] >= 0)
+			ceder_a(pids[1-yo]);
+		else
+			ceder();
+	}
+}
+
+/*
+ * Una fase de intercambios; el padre decide cuando acaba y mide ticks
+ * y cesiones. Con tiempo real dura lo que la tarea EDF.
+ */
+static void fase(int yo, int con_ceder_a, int con_tr){
+	estadisticas antes, despues;
+	int n = 0, sigue;
+
+	if (yo == 0){
+		directo = con_ceder_a;
+		estadisticas_sistema(&antes);
+		if (con_tr){
+			tr_activa = 1;
+			if (crear_proceso_args("pingpong", 2, tarea_tr) < 0){
+				printf("pingpong: error creando la tarea EDF\n");
+				tr_activa = 0;
+			}
+		}
+	}
+	do {
+		esperar_turno(yo);
+		if (yo == 0)
+			seguir = con_tr ? tr_activa : n < INTERCAMBIOS;
+		sigue = seguir;		/* antes de pasar el turno */
+		turno = 1 - yo;
+		n++;
+	} while (sigue);
+	if (yo == 0){
+		esperar_turno(yo);
+		estadisticas_sistema(&despues);
+		printf("pingpong: %d turnos con %s%s en %lu ticks, %lu cesiones\n",
+			n - 1, con_ceder_a ? "ceder_a" : "ceder",
+			con_tr ? " y una tarea EDF" : "",
+			despues.ticks - antes.ticks,
+			despues.cambios[CAUSA_CEDER] - antes.cambios[CAUSA_CEDER]);
+	}
+}
+
+/*
+ * Tarea EDF que compite con las cesiones: mide cuanto tarda en ejecutar
+ * desde que empieza cada periodo
+ */
+static void tiempo_real(){
+	estadisticas est;
+	unsigned long inicio, comienzo, retraso, max_retraso = 0;
+	int i, perdidos = 0;
+
+	estadisticas_sistema(&est);
+	inicio = est.ticks;
+	if (fijar_tiempo_real(PERIODO_TR, PRESUPUESTO_TR) < 0){
+		printf("pingpong: tarea EDF no admitida\n");
+		tr_activa = 0;
+		return;
+	}
+	for (i=1; i<=PERIODOS_TR; i++){
+		perdidos = esperar_periodo();
+		estadisticas_sistema(&est);
+		comienzo = inicio + i * PERIODO_TR;
+		retraso = est.ticks > comienzo ? est.ticks - comienzo : 0;
+		if (retraso > max_retraso)
+			max_retraso = retraso;
+	}
+	printf("pingpong: tarea EDF, %d periodos, %d plazos perdidos, "
+		"retraso maximo %lu ticks\n", PERIODOS_TR, perdidos, max_retraso);
+	tr_activa = 0;
+}
+
+int main(int argc, char *argv[]){
+	int yo = argc > 1;
+
+	if (argc > 1 && argv[1][0] == 't'){
+		tiempo_real();
+		return 0;
+	}
+	if (yo == 0){
+		pids[0] = get_pid();
+		if (crear_proceso_args("carga", 3, calculo) < 0 ||
+		    crear_proceso_args("pingpong", 2, hijo) < 0){
+			printf("pingpong: error creando procesos\n");
+			return -1;
+		}
+		while (pids[1] < 0)	/* que el hijo tenga pid antes de medir */
+			ceder();
+	} else
+		pids[1] = get_pid();
+
+	fase(yo, 1, 0);
+	fase(yo, 0, 0);
+	fase(yo, 1, 1);
+	return 0;
+}
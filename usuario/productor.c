@@ -0,0 +1,36 @@
+/*
+ * usuario/productor.c
+ *
+ * Programa de usuario que crea una tuberia, arranca un consumidor que
+ * hereda sus descriptores y le envia mensajes a traves de ella.
+ */
+
+#include "servicios.h"
+
+#define TOT_ITER 10	/* mensajes enviados */
+
+int main(){
+	int desc[2];
+	int i;
+	char mensaje[]="productor: mensaje por la tuberia\n";
+
+	if (crear_tuberia(desc)<0){
+		printf("productor: error creando tuberia\n");
+		return -1;
+	}
+	if (crear_proceso("consumidor")<0)
+		printf("productor: error creando consumidor\n");
+
+	/* el productor solo escribe */
+	cerrar_desc(desc[0]);
+
+	for (i=0; i<TOT_ITER; i++)
+		if (escribir_desc(desc[1], mensaje, sizeof(mensaje)-1)<0)
+			printf("productor: nadie lee la tuberia\n");
+
+	/* el consumidor vera fin de fichero */
+	cerrar_desc(desc[1]);
+	espera();
+	printf("productor: termina\n");
+	return 0;
+}
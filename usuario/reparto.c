@@ -0,0 +1,63 @@
+/*
+ * usuario/reparto.c
+ *
+ * Programa de usuario que reparte el procesador entre dos trabajos: A
+ * con un proceso de calculo y B con cuatro, cada uno en su grupo. Con
+ * el mismo peso se lo reparten a medias en vez de 1 a 4; luego B pasa
+ * a tener el triple de peso y por ultimo A queda limitado por una
+ * cuota del 20% del periodo.
+ */
+
+#include "servicios.h"
+
+#define SEGUNDOS 3
+
+static char *calculo[]={"carga", "400000000", "1000"};
+
+/* crea un grupo con n procesos de calculo sin salir del grupo actual */
+static int lanzar(int n){
+	int anterior = get_gid(), gid, i;
+
+	gid = crear_grupo();
+	for (i=0; i<n; i++)
+		if (crear_proceso_args("carga", 3, calculo) < 0)
+			printf("reparto: error creando carga\n");
+	fijar_grupo(anterior);
+	return gid;
+}
+
+/* ticks que reciben los grupos a y b durante SEGUNDOS segundos */
+static void medir(char *caso, int a, int b){
+	info_reparto a0, b0, a1, b1;
+	unsigned long ta, tb;
+
+	leer_reparto(a, &a0);
+	leer_reparto(b, &b0);
+	dormir(SEGUNDOS);
+	leer_reparto(a, &a1);
+	leer_reparto(b, &b1);
+	ta = a1.total - a0.total;
+	tb = b1.total - b0.total;
+	printf("reparto: %s: A %lu ticks (%lu%%), B %lu ticks (%lu%%), "
+		"A estrangulado %lu veces\n", caso, ta, 100 * ta / (ta + tb),
+		tb, 100 * tb / (ta + tb),
+		a1.estrangulamientos - a0.estrangulamientos);
+}
+
+int main(){
+	int a, b;
+
+	a = lanzar(1);
+	b = lanzar(4);
+	medir("mismo peso", a, b);
+	fijar_reparto(b, 3 * PESO_DEFECTO, 0);
+	medir("B con peso triple", a, b);
+	fijar_reparto(b, PESO_DEFECTO, 0);
+	fijar_reparto(a, PESO_DEFECTO, leer_parametro(PARAM_PERIODO_REPARTO) / 5);
+	medir("A con cuota del 20%", a, b);
+	matar_grupo(a);
+	matar_grupo(b);
+	esperar_grupo(a);
+	esperar_grupo(b);
+	return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * usuario/supervisor.c
+ *
+ * Programa de usuario que atiende a la vez el teclado, la terminacion
+ * de sus hijos y un plazo periodico con una sola llamada bloqueante.
+ */
+
+#include "servicios.h"
+
+#define PLAZO 100	/* ticks sin eventos tras los que avisa */
+#define TOT_PLAZOS 3	/* plazos vencidos tras acabar los hijos */
+
+int main(){
+	int hijos = 0, plazos = 0, eventos;
+
+	if (crear_proceso("simplon") == 0)
+		hijos++;
+	if (crear_proceso("dormilon") == 0)
+		hijos++;
+
+	while (hijos > 0 || plazos < TOT_PLAZOS){
+		eventos = esperar_eventos(EVENTO_TECLADO | EVENTO_HIJO, PLAZO);
+		if (eventos < 0){
+			printf("supervisor: error esperando eventos\n");
+			return -1;
+		}
+		if (eventos & EVENTO_TECLADO)
+			printf("supervisor: tecla %c\n", leer_caracter());
+		if (eventos & EVENTO_HIJO){
+			hijos--;
+			printf("supervisor: termina un hijo, quedan %d\n", hijos);
+		}
+		if (eventos & EVENTO_TIEMPO){
+			plazos++;
+			printf("supervisor: %d ticks sin eventos\n", PLAZO);
+		}
+	}
+	printf("supervisor: termina\n");
+	return 0;
+}
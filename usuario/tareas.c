@@ -0,0 +1,60 @@
+/*
+ * usuario/tareas.c
+ *
+ * Programa de usuario que ejecuta cientos de hilos de la biblioteca de
+ * hilos en un solo proceso: unos pocos duermen con hilo_dormir mientras
+ * los demas se van cediendo el procesador con hilo_ceder hasta que han
+ * despertado todos, y main los espera a todos.
+ */
+
+#include "servicios.h"
+#include "hilos.h"
+
+#define TRABAJADORES 200
+#define DORMILONES 4
+
+static volatile unsigned long cesiones;
+static volatile int despiertos;
+
+static unsigned long ticks(){
+	estadisticas est;
+
+	estadisticas_sistema(&est);
+	return est.ticks;
+}
+
+static void trabajador(void *arg){
+	while (despiertos < DORMILONES){
+		cesiones++;
+		hilo_ceder();
+	}
+}
+
+static void dormilon(void *arg){
+	long segundos = (long)arg;
+	unsigned long antes = ticks();
+
+	hilo_dormir(segundos);
+	despiertos++;
+	printf("tareas: hilo %d despierta tras %ld s (%lu ticks) con %lu "
+		"cesiones hechas\n", hilo_id(), segundos, ticks() - antes,
+		cesiones);
+}
+
+int main(){
+	int ids[TRABAJADORES + DORMILONES];
+	unsigned long antes;
+	int i, n = 0;
+
+	antes = ticks();
+	for (i=0; i<DORMILONES; i++)
+		ids[n++] = hilo_crear(dormilon, (void *)(long)(i % 2 + 1));
+	for (i=0; i<TRABAJADORES; i++)
+		ids[n++] = hilo_crear(trabajador, 0);
+	for (i=0; i<n; i++)
+		if (ids[i] < 0 || hilo_esperar(ids[i]) < 0)
+			printf("tareas: error con el hilo %d\n", i);
+	printf("tareas: %d hilos en el proceso %d, %lu cesiones en %lu ticks\n",
+		n, get_pid(), cesiones, ticks() - antes);
+	return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * usuario/top.c
+ *
+ * Programa de usuario que muestra periodicamente las estadisticas
+ * globales del sistema: cambios de contexto, llamadas, interrupciones
+ * y carga media.
+ */
+
+#include "servicios.h"
+
+#define TOT_MUESTRAS 5	/* veces que se muestran las estadisticas */
+#define PERIODO 1	/* segundos entre muestras */
+
+static char *causas[NUM_CAUSAS]={"dormir", "espera", "bloqueo", "fin",
+	"expulsion", "ceder"};
+
+/* imprime un valor en coma fija con dos decimales */
+static void imprime_carga(unsigned long carga){
+	unsigned long centesimas = ((carga & (UNO_CARGA - 1)) * 100) >> SHIFT_CARGA;
+
+	printf(" %lu.%s%lu", carga >> SHIFT_CARGA, centesimas < 10 ? "0" : "",
+		centesimas);
+}
+
+int main(){
+	estadisticas est;
+	unsigned long voluntarios;
+	int i, j;
+
+	for (i=0; i<TOT_MUESTRAS; i++){
+		if (estadisticas_sistema(&est)<0){
+			printf("top: error leyendo estadisticas\n");
+			return -1;
+		}
+		voluntarios = 0;
+		for (j=0; j<NUM_CAUSAS; j++)
+			if (j != CAUSA_EXPULSION)
+				voluntarios += est.cambios[j];
+
+		printf("top: tick %lu listos %d carga", est.ticks, est.listos);
+		for (j=0; j<3; j++)
+			imprime_carga(est.carga[j]);
+		printf("\ntop: cambios voluntarios %lu involuntarios %lu (",
+			voluntarios, est.cambios[CAUSA_EXPULSION]);
+		for (j=0; j<NUM_CAUSAS; j++)
+			printf(" %s %lu", causas[j], est.cambios[j]);
+		printf(" )\ntop: llamadas");
+		for (j=0; j<NSERVICIOS; j++)
+			printf(" %lu", est.llamadas[j]);
+		printf("\ntop: interrupciones");
+		for (j=0; j<NUM_VECTORES; j++)
+			printf(" %lu", est.interrupciones[j]);
+		printf("\n");
+		dormir(PERIODO);
+	}
+	return 0;
+}